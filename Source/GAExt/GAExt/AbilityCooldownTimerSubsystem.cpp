@@ -0,0 +1,147 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityCooldownTimerSubsystem.h"
+
+#include "GAEAbilitySystemComponent.h"
+#include "GAExtStatGroup.h"
+
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityCooldownTimerSubsystem)
+
+
+void UAbilityCooldownTimerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const auto* World{ GetWorld() };
+
+	CurrentTick = World ? static_cast<uint64>(World->GetTimeSeconds() / TickSeconds) : 0;
+}
+
+void UAbilityCooldownTimerSubsystem::Tick(float DeltaTime)
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("UAbilityCooldownTimerSubsystem::Tick()"), STAT_UAbilityCooldownTimerSubsystem_Tick, STATGROUP_Ability);
+
+	Super::Tick(DeltaTime);
+
+	const auto* World{ GetWorld() };
+
+	if (!World)
+	{
+		return;
+	}
+
+	const auto NowTick{ static_cast<uint64>(World->GetTimeSeconds() / TickSeconds) };
+
+	TArray<FAbilityCooldownTimer> ExpiredTimers;
+
+	while (CurrentTick < NowTick)
+	{
+		AdvanceTick(ExpiredTimers);
+	}
+
+	NumTimers -= ExpiredTimers.Num();
+
+	// Notify after advancing since the AbilitySystemComponents schedule their next timers while being notified.
+
+	for (const auto& Timer : ExpiredTimers)
+	{
+		if (auto* ASC{ Timer.ASC.Get() })
+		{
+			ASC->HandleCooldownTimerExpired(Timer.Serial);
+		}
+	}
+}
+
+bool UAbilityCooldownTimerSubsystem::IsTickable() const
+{
+	return (NumTimers > 0) && Super::IsTickable();
+}
+
+TStatId UAbilityCooldownTimerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAbilityCooldownTimerSubsystem, STATGROUP_Tickables);
+}
+
+
+void UAbilityCooldownTimerSubsystem::InsertTimer(FAbilityCooldownTimer&& Timer)
+{
+	const auto Delta{ (Timer.ExpireTick > CurrentTick) ? (Timer.ExpireTick - CurrentTick) : 0 };
+
+	for (auto Level{ 0 }; Level < NumLevels; ++Level)
+	{
+		const auto LevelShift{ SlotBits * Level };
+		const auto bFitsLevel{ Delta < (uint64(1) << (LevelShift + SlotBits)) };
+
+		if (bFitsLevel || (Level == NumLevels - 1))
+		{
+			// Timers beyond the range of the wheel expire early and are rescheduled by the AbilitySystemComponent.
+
+			if (!bFitsLevel)
+			{
+				Timer.ExpireTick = CurrentTick + (uint64(1) << (LevelShift + SlotBits)) - 1;
+			}
+
+			GetSlot(Level, (Timer.ExpireTick >> LevelShift) & SlotMask).Add(MoveTemp(Timer));
+			return;
+		}
+	}
+}
+
+void UAbilityCooldownTimerSubsystem::AdvanceTick(TArray<FAbilityCooldownTimer>& OutExpiredTimers)
+{
+	++CurrentTick;
+
+	// Move down the timers of the upper level slot that starts on this tick.
+
+	for (auto Level{ 1 }; Level < NumLevels; ++Level)
+	{
+		const auto LevelShift{ SlotBits * Level };
+
+		if ((CurrentTick & ((uint64(1) << LevelShift) - 1)) != 0)
+		{
+			break;
+		}
+
+		auto Timers{ MoveTemp(GetSlot(Level, (CurrentTick >> LevelShift) & SlotMask)) };
+
+		for (auto& Timer : Timers)
+		{
+			InsertTimer(MoveTemp(Timer));
+		}
+	}
+
+	auto& Slot{ GetSlot(0, CurrentTick & SlotMask) };
+
+	OutExpiredTimers.Append(MoveTemp(Slot));
+	Slot.Reset();
+}
+
+
+void UAbilityCooldownTimerSubsystem::ScheduleTimer(UGAEAbilitySystemComponent* ASC, double WorldTime, uint32 Serial)
+{
+	if (!ASC)
+	{
+		return;
+	}
+
+	// The wheel does not advance while it has no timers, so catch up with the world time without stepping through the missed ticks.
+	// Safe since all the slots are empty.
+
+	if (NumTimers == 0)
+	{
+		if (const auto* World{ GetWorld() })
+		{
+			CurrentTick = FMath::Max(CurrentTick, static_cast<uint64>(World->GetTimeSeconds() / TickSeconds));
+		}
+	}
+
+	// The slot of the current tick has already been processed.
+
+	const auto ExpireTick{ FMath::Max(static_cast<uint64>(FMath::CeilToDouble(WorldTime / TickSeconds)), CurrentTick + 1) };
+
+	InsertTimer(FAbilityCooldownTimer(ASC, ExpireTick, Serial));
+
+	++NumTimers;
+}
@@ -0,0 +1,96 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "AbilityCooldownTimerSubsystem.generated.h"
+
+class UGAEAbilitySystemComponent;
+
+
+/**
+ * Request of an AbilitySystemComponent to update its cooldowns at a tick
+ */
+struct FAbilityCooldownTimer
+{
+public:
+	FAbilityCooldownTimer() {}
+
+	FAbilityCooldownTimer(UGAEAbilitySystemComponent* InASC, uint64 InExpireTick, uint32 InSerial)
+		: ASC(InASC), ExpireTick(InExpireTick), Serial(InSerial)
+	{}
+
+public:
+	TWeakObjectPtr<UGAEAbilitySystemComponent> ASC;
+
+	uint64 ExpireTick{ 0 };
+
+	//
+	// Serial of the request on the AbilitySystemComponent, which ignores the timer if it has been rescheduled since
+	//
+	uint32 Serial{ 0 };
+
+};
+
+
+/**
+ * A subsystem that tracks the cooldown expirations of all GAE AbilitySystemComponents in the world in a hierarchical timer wheel
+ * and notifies the expired ones in a single batch each frame.
+ * 
+ * Tips:
+ *	Scheduling is O(1) and a frame costs O(expired timers), regardless of the number of timers in flight.
+ *	Rescheduling does not remove the previous timer, the AbilitySystemComponent ignores it by its serial instead.
+ */
+UCLASS()
+class GAEXT_API UAbilityCooldownTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UAbilityCooldownTimerSubsystem() {}
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	//
+	// Length of a single tick of the wheel in seconds
+	//
+	static constexpr double TickSeconds{ 1.0 / 60.0 };
+
+	static constexpr int32 SlotBits{ 6 };
+	static constexpr int32 NumSlots{ 1 << SlotBits };
+	static constexpr uint64 SlotMask{ NumSlots - 1 };
+	static constexpr int32 NumLevels{ 4 };
+
+	//
+	// Slots of each level, level N covers NumSlots^(N + 1) ticks
+	//
+	TArray<FAbilityCooldownTimer> Wheel[NumLevels * NumSlots];
+
+	//
+	// Last tick that has been processed
+	//
+	uint64 CurrentTick{ 0 };
+
+	int32 NumTimers{ 0 };
+
+protected:
+	TArray<FAbilityCooldownTimer>& GetSlot(int32 Level, uint64 SlotIndex) { return Wheel[Level * NumSlots + static_cast<int32>(SlotIndex)]; }
+
+	void InsertTimer(FAbilityCooldownTimer&& Timer);
+
+	/**
+	 * Advances a tick, cascades the upper levels and moves the timers that expire on the tick to OutExpiredTimers
+	 */
+	void AdvanceTick(TArray<FAbilityCooldownTimer>& OutExpiredTimers);
+
+public:
+	/**
+	 * Schedules the AbilitySystemComponent to update its cooldowns at the world time
+	 */
+	void ScheduleTimer(UGAEAbilitySystemComponent* ASC, double WorldTime, uint32 Serial);
+
+};
@@ -2,6 +2,7 @@
 
 #include "AbilitySet.h"
 
+#include "GAEAbilitySystemComponent.h"
 #include "GAExtLogs.h"
 
 #include "Abilities/GameplayAbility.h"
@@ -81,6 +82,9 @@ void FAbilitySet_GrantedHandles::AddAbilities(UAbilitySystemComponent* ASC, cons
 		}
 
 		// Grant the gameplay abilities.
+		// "OnSpawn" abilities are activated in a single pass at the end of this scope.
+
+		FScopedOnSpawnActivationDeferral OnSpawnActivationDeferral{ ASC };
 
 		for (int32 AbilityIndex{ 0 }; AbilityIndex < Abilities.Num(); ++AbilityIndex)
 		{
@@ -272,6 +276,9 @@ void UAbilitySet::GiveToAbilitySystem(UAbilitySystemComponent* ASC, FAbilitySet_
 		}
 
 		// Grant the gameplay abilities.
+		// "OnSpawn" abilities are activated in a single pass at the end of this scope.
+
+		FScopedOnSpawnActivationDeferral OnSpawnActivationDeferral{ ASC };
 
 		for (int32 AbilityIndex{ 0 }; AbilityIndex < GrantedGameplayAbilities.Num(); ++AbilityIndex)
 		{
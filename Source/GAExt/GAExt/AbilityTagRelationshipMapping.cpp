@@ -2,6 +2,8 @@
 
 #include "AbilityTagRelationshipMapping.h"
 
+#include "Type/AbilityTagBitSet.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityTagRelationshipMapping)
 
 
@@ -32,6 +34,27 @@ void UAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(
 	}
 }
 
+void UAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(
+	const FAbilityTagBitSet& AbilityTagBits,
+	FGameplayTagContainer* OutTagsToBlock,
+	FGameplayTagContainer* OutTagsToCancel) const
+{
+	for (const auto& Each : AbilityTagRelationships)
+	{
+		if (AbilityTagBits.HasTag(Each.AbilityTag))
+		{
+			if (OutTagsToBlock)
+			{
+				OutTagsToBlock->AppendTags(Each.AbilityTagsToBlock);
+			}
+			if (OutTagsToCancel)
+			{
+				OutTagsToCancel->AppendTags(Each.AbilityTagsToCancel);
+			}
+		}
+	}
+}
+
 void UAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(
 	const FGameplayTagContainer& AbilityTags,
 	FGameplayTagContainer* OutActivationRequired,
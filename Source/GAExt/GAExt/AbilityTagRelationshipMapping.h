@@ -8,6 +8,8 @@
 
 #include "AbilityTagRelationshipMapping.generated.h"
 
+struct FAbilityTagBitSet;
+
 
 /** 
  * Struct that defines the relationship between different ability tags 
@@ -78,6 +80,14 @@ public:
 		FGameplayTagContainer* OutTagsToBlock,
 		FGameplayTagContainer* OutTagsToCancel) const;
 
+	/** 
+	 * Same as above, but with ability tags (including their parent tags) as a bit set 
+	 */
+	void GetAbilityTagsToBlockAndCancel(
+		const FAbilityTagBitSet& AbilityTagBits,
+		FGameplayTagContainer* OutTagsToBlock,
+		FGameplayTagContainer* OutTagsToCancel) const;
+
 	/** 
 	 * Given a set of ability tags, add additional required and blocking tags 
 	 */
@@ -3,6 +3,7 @@
 #include "AbilityCost.h"
 
 #include "GAEGameplayAbility.h"
+#include "GAEAbilitySystemComponent.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityCost)
 
@@ -11,3 +12,12 @@ UAbilityCost::UAbilityCost(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
+
+
+void UAbilityCost::NotifyCostChanged(const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	if (auto* GAEASC{ ActorInfo ? Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr })
+	{
+		GAEASC->NotifyAbilityCostChanged();
+	}
+}
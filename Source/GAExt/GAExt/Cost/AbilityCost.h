@@ -50,6 +50,15 @@ public:
 		, const FGameplayAbilityActorInfo* ActorInfo
 		, const FGameplayAbilityActivationInfo ActivationInfo) PURE_VIRTUAL(, );
 
+	/**
+	 * Returns whether every change of the values read by CheckCost() is notified to the ability system component
+	 * (UGAEAbilitySystemComponent::NotifyAbilityCostChanged()), so that activation check results can be cached.
+	 *
+	 * Tips:
+	 *	Abilities with a cost returning false are always checked again by the activation query.
+	 */
+	virtual bool IsCostChangeNotified() const { return false; }
+
 
 	///////////////////////////////////////////////////////////////
 	// Optional functions
@@ -60,6 +69,34 @@ public:
 	//  However, for complex processes, it is recommended that they be implemented within the respective GameplayAbility. (e.g, reloading).
 	//
 public:
+	/**
+	 * Executed when ability is given.
+	 *
+	 * Tips:
+	 *	Override this function if necessary to precompute values, etc.
+	 *
+	 * Note:
+	 *  Ability is guaranteed to be non-null on entry.
+	 */
+	virtual void OnGiveAbility(
+		const UGAEGameplayAbility* Ability
+		, const FGameplayAbilityActorInfo* ActorInfo
+		, const FGameplayAbilitySpec& Spec) {}
+
+	/**
+	 * Executed when the level of the ability spec has changed after it was given.
+	 *
+	 * Tips:
+	 *	Override this function if necessary to precompute values for the new level, etc.
+	 *
+	 * Note:
+	 *  Ability is guaranteed to be non-null on entry.
+	 */
+	virtual void OnAbilityLevelChanged(
+		const UGAEGameplayAbility* Ability
+		, const FGameplayAbilityActorInfo* ActorInfo
+		, const FGameplayAbilitySpec& Spec) {}
+
 	/**
 	 * Executed when ability is removed.
 	 *
@@ -113,4 +150,12 @@ protected:
 		return GetTypedOuter<T>();
 	}
 
+	/**
+	 * Notifies the ability system component of the ActorInfo that the values read by CheckCost() have changed
+	 *
+	 * Tips:
+	 *	Call this after the cost has changed the values by itself (e.g, in ApplyCost()).
+	 */
+	void NotifyCostChanged(const FGameplayAbilityActorInfo* ActorInfo) const;
+
 };
@@ -3,36 +3,83 @@
 #include "AbilityCost_StatTag.h"
 
 #include "GAEGameplayAbility.h"
+#include "GAEAbilitySystemComponent.h"
 
 #include "GameplayTag/GameplayTagStackInterface.h"
 
-#include "GameFramework/PlayerState.h"
-#include "GameFramework/Controller.h"
-#include "GameFramework/Actor.h"
-
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityCost_StatTag)
 
 
+FStatTagCostLevelValues::FStatTagCostLevelValues(const FStatTagCostDefinition& Definition, int32 AbilityLevel)
+	: Cost(FMath::TruncToInt(Definition.Cost.GetValueAtLevel(AbilityLevel)))
+	, MaxValue(FMath::TruncToInt(Definition.MaxValue.GetValueAtLevel(AbilityLevel)))
+	, DefaultValue(FMath::TruncToInt(Definition.DefaultValue.GetValueAtLevel(AbilityLevel)))
+{
+}
+
+
 UAbilityCost_StatTag::UAbilityCost_StatTag(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
 
 
+#if WITH_EDITOR 
+void UAbilityCost_StatTag::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	LevelValuesCache.Reset();
+}
+#endif
+
+
 bool UAbilityCost_StatTag::CheckCost(const UGAEGameplayAbility* Ability, const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, FGameplayTagContainer* OptionalRelevantTags) const
 {
 	auto Result{ true };
 
 	const auto AbilityLevel{ Ability->GetAbilityLevel(Handle, ActorInfo) };
 
-	for (const auto& Cost : StatTagCosts)
+	FStatTagCostTargets ResolvedTargets;
+	const auto& Targets{ GetCostTargets(Handle, ActorInfo, ResolvedTargets) };
+
+	// Share the stack counts read with other abilities if this is a part of a query of all abilities
+
+	auto* QueryContext{ FAbilityActivationQueryContext::Get(ActorInfo->AbilitySystemComponent.Get()) };
+
+	for (auto Index{ 0 }; Index < StatTagCosts.Num(); ++Index)
 	{
-		if (auto* Interface{ GetCostTarget<IGameplayTagStackInterface>(Cost.Target) })
+		const auto& Cost{ StatTagCosts[Index] };
+
+		const auto& Target{ Targets.GetTarget(Cost.Target) };
+
+		if (auto* Interface{ Target.Get() })
 		{
-			const auto CostReal{ Cost.Cost.GetValueAtLevel(AbilityLevel) };
-			const auto CostValue{ FMath::TruncToInt(CostReal) };
+			auto* TargetObject{ Target.GetObject() };
+
+			const auto CostValue{ GetLevelValues(AbilityLevel, Index).Cost };
+
+			int32 StackCount;
+
+			if (QueryContext)
+			{
+				const auto Key{ MakeTuple(TObjectKey<UObject>(TargetObject), Cost.StatTag) };
+
+				if (const auto* CachedStackCount{ QueryContext->StatTagStackCounts.Find(Key) })
+				{
+					StackCount = *CachedStackCount;
+				}
+				else
+				{
+					StackCount = QueryContext->StatTagStackCounts.Add(Key, Interface->GetStatTagStackCount(Cost.StatTag));
+				}
+			}
+			else
+			{
+				StackCount = Interface->GetStatTagStackCount(Cost.StatTag);
+			}
 
-			Result &= (Interface->GetStatTagStackCount(Cost.StatTag) >= CostValue);
+			Result &= (StackCount >= CostValue);
 		}
 	}
 	
@@ -50,20 +97,54 @@ void UAbilityCost_StatTag::ApplyCost(const UGAEGameplayAbility* Ability, const F
 
 	const auto AbilityLevel{ Ability->GetAbilityLevel(Handle, ActorInfo) };
 
-	for (const auto& Cost : StatTagCosts)
+	// Copy since removing stacks may grant or remove abilities
+
+	FStatTagCostTargets ResolvedTargets;
+	const auto Targets{ GetCostTargets(Handle, ActorInfo, ResolvedTargets) };
+
+	auto bStackChanged{ false };
+
+	for (auto Index{ 0 }; Index < StatTagCosts.Num(); ++Index)
 	{
-		if (auto* Interface{ GetCostTarget<IGameplayTagStackInterface>(Cost.Target) })
+		const auto& Cost{ StatTagCosts[Index] };
+
+		if (auto* Interface{ Targets.GetTarget(Cost.Target).Get() })
 		{
-			const auto CostReal{ Cost.Cost.GetValueAtLevel(AbilityLevel) };
-			const auto CostValue{ FMath::TruncToInt(CostReal) };
+			Interface->RemoveStatTagStack(Cost.StatTag, GetLevelValues(AbilityLevel, Index).Cost);
 
-			Interface->RemoveStatTagStack(Cost.StatTag, CostValue);
+			bStackChanged = true;
 		}
 	}
+
+	if (bStackChanged)
+	{
+		NotifyCostChanged(ActorInfo);
+	}
+}
+
+void UAbilityCost_StatTag::OnGiveAbility(const UGAEGameplayAbility* Ability, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
+{
+	// Evaluate the curves of the granted level in advance so that they are not evaluated during activation checks
+
+	CacheLevelValues(Spec.Level);
+
+	if (ActorInfo)
+	{
+		StoreCostTargets(ActorInfo, Spec);
+	}
+}
+
+void UAbilityCost_StatTag::OnAbilityLevelChanged(const UGAEGameplayAbility* Ability, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
+{
+	CacheLevelValues(Spec.Level);
 }
 
 void UAbilityCost_StatTag::OnAvatarSet(const UGAEGameplayAbility* Ability, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
 {
+	// Resolve again because the ActorInfo has been updated
+
+	const auto Targets{ StoreCostTargets(ActorInfo, Spec) };
+
 	// Must have authority
 
 	if (!ActorInfo->IsNetAuthority())
@@ -71,60 +152,102 @@ void UAbilityCost_StatTag::OnAvatarSet(const UGAEGameplayAbility* Ability, const
 		return;
 	}
 
-	const auto AbilityLevel{ Spec.Level };
+	auto bStackChanged{ false };
 
-	for (const auto& Cost : StatTagCosts)
+	for (auto Index{ 0 }; Index < StatTagCosts.Num(); ++Index)
 	{
+		const auto& Cost{ StatTagCosts[Index] };
+
 		if (Cost.bShouldInitStatTag)
 		{
-			if (auto* Interface{ GetCostTarget<IGameplayTagStackInterface>(Cost.Target) })
+			if (auto* Interface{ Targets.GetTarget(Cost.Target).Get() })
 			{
-				const auto MaxReal{ Cost.MaxValue.GetValueAtLevel(AbilityLevel) };
-				const auto MaxValue{ FMath::TruncToInt(MaxReal) };
+				const auto LevelValues{ GetLevelValues(Spec.Level, Index) };
 
-				Interface->SetMaxStatTagStack(Cost.StatTag, MaxValue);
+				Interface->SetMaxStatTagStack(Cost.StatTag, LevelValues.MaxValue);
 
 				if (!Cost.bDoNotInitDefaultValue)
 				{
-					const auto DefaultReal{ Cost.DefaultValue.GetValueAtLevel(AbilityLevel) };
-					const auto DefaultValue{ FMath::TruncToInt(DefaultReal) };
-
-					Interface->SetStatTagStack(Cost.StatTag, DefaultValue);
+					Interface->SetStatTagStack(Cost.StatTag, LevelValues.DefaultValue);
 				}
+
+				bStackChanged = true;
 			}
 		}
 	}
+
+	if (bStackChanged)
+	{
+		NotifyCostChanged(ActorInfo);
+	}
 }
 
 
-UObject* UAbilityCost_StatTag::GetStatTagCostTarget(EStatTagCostTarget Type) const
+void UAbilityCost_StatTag::CacheLevelValues(int32 AbilityLevel)
 {
-	auto* GAEAbility{ GetOwnerAbility() };
+	// Evaluate again if StatTagCosts has been changed after caching
+
+	if (const auto* CachedValues{ LevelValuesCache.Find(AbilityLevel) })
+	{
+		if (CachedValues->Num() == StatTagCosts.Num())
+		{
+			return;
+		}
+	}
+
+	TArray<FStatTagCostLevelValues> NewValues;
+	NewValues.Reserve(StatTagCosts.Num());
+
+	for (const auto& Cost : StatTagCosts)
+	{
+		NewValues.Emplace(Cost, AbilityLevel);
+	}
+
+	LevelValuesCache.Add(AbilityLevel, MoveTemp(NewValues));
+}
 
-	switch (Type)
+FStatTagCostLevelValues UAbilityCost_StatTag::GetLevelValues(int32 AbilityLevel, int32 Index) const
+{
+	if (const auto* CachedValues{ LevelValuesCache.Find(AbilityLevel) })
 	{
-	case EStatTagCostTarget::SourceObject:
-		return GAEAbility->GetCurrentSourceObject();
-		break;
+		if (CachedValues->IsValidIndex(Index) && (CachedValues->Num() == StatTagCosts.Num()))
+		{
+			return (*CachedValues)[Index];
+		}
+	}
 
-	case EStatTagCostTarget::Avatar:
-		return GAEAbility->GetAvatarActorFromActorInfo();
-		break;
+	return FStatTagCostLevelValues(StatTagCosts[Index], AbilityLevel);
+}
 
-	case EStatTagCostTarget::Owner:
-		return GAEAbility->GetOwningActorFromActorInfo();
-		break;
+FStatTagCostTargets UAbilityCost_StatTag::StoreCostTargets(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
+{
+	FStatTagCostTargets Targets;
+	Targets.Resolve(ActorInfo, &Spec);
 
-	case EStatTagCostTarget::Controller:
-		return GAEAbility->GetController();
-		break;
+	if (auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) })
+	{
+		GAEASC->SetSpecStatTagCostTargets(Spec.Handle, Targets);
+	}
 
-	case EStatTagCostTarget::PlayerState:
-		return GAEAbility->GetPlayerState();
-		break;
+	return Targets;
+}
 
-	default:
-		return nullptr;
-		break;
+const FStatTagCostTargets& UAbilityCost_StatTag::GetCostTargets(FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, FStatTagCostTargets& OutResolvedTargets)
+{
+	auto* ASC{ ActorInfo->AbilitySystemComponent.Get() };
+	const auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(ASC) };
+
+	if (const auto* StoredTargets{ GAEASC ? GAEASC->FindSpecStatTagCostTargets(Handle) : nullptr })
+	{
+		if (StoredTargets->IsUpToDate(ActorInfo))
+		{
+			return *StoredTargets;
+		}
 	}
+
+	// Resolve without storing, since this cost is shared by all the AbilitySystemComponents if the ability is NonInstanced
+
+	OutResolvedTargets.Resolve(ActorInfo, ASC ? ASC->FindAbilitySpecFromHandle(Handle) : nullptr);
+
+	return OutResolvedTargets;
 }
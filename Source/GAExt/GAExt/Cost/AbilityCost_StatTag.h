@@ -44,6 +44,26 @@ public:
 };
 
 
+/**
+ * Integer values of FStatTagCostDefinition evaluated at a specific ability level
+ */
+struct FStatTagCostLevelValues
+{
+public:
+	FStatTagCostLevelValues() {}
+
+	FStatTagCostLevelValues(const FStatTagCostDefinition& Definition, int32 AbilityLevel);
+
+public:
+	int32 Cost{ 0 };
+
+	int32 MaxValue{ 0 };
+
+	int32 DefaultValue{ 0 };
+
+};
+
+
 /**
  * AbilityCost class of the type that consumes the OwningActor or AvatarActor's StatTag
  */
@@ -61,6 +81,21 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Costs", meta = (TitleProperty = "{Target} {StatTag}", ShowOnlyInnerProperties))
 	TArray<FStatTagCostDefinition> StatTagCosts;
 
+protected:
+	//
+	// Values of StatTagCosts evaluated for each ability level
+	// 
+	// Tips:
+	//	Each array is in the same order as StatTagCosts.
+	//	Only filled when the ability is given or its level changes, never while checking or applying costs.
+	//
+	TMap<int32, TArray<FStatTagCostLevelValues>> LevelValuesCache;
+
+public:
+#if WITH_EDITOR 
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 public:
 	virtual bool CheckCost(
 		const UGAEGameplayAbility* Ability
@@ -74,7 +109,26 @@ public:
 		, const FGameplayAbilityActorInfo* ActorInfo
 		, const FGameplayAbilityActivationInfo ActivationInfo) override;
 
+	/**
+	 * Stack changes made by this cost are notified by itself.
+	 *
+	 * Note:
+	 *	Stack changes made by anything else (e.g, picking up ammo, stacks replicated to clients)
+	 *	must be notified with UGAEAbilitySystemComponent::NotifyAbilityCostChanged().
+	 */
+	virtual bool IsCostChangeNotified() const override { return true; }
+
 public:
+	virtual void OnGiveAbility(
+		const UGAEGameplayAbility* Ability
+		, const FGameplayAbilityActorInfo* ActorInfo
+		, const FGameplayAbilitySpec& Spec) override;
+
+	virtual void OnAbilityLevelChanged(
+		const UGAEGameplayAbility* Ability
+		, const FGameplayAbilityActorInfo* ActorInfo
+		, const FGameplayAbilitySpec& Spec) override;
+
 	virtual void OnAvatarSet(
 		const UGAEGameplayAbility* Ability
 		, const FGameplayAbilityActorInfo* ActorInfo
@@ -84,12 +138,40 @@ public:
 	//////////////////////////////////////////////////////////////
 	// Utilities
 protected:
-	UObject* GetStatTagCostTarget(EStatTagCostTarget Type) const;
-
-	template<typename T>
-	T* GetCostTarget(EStatTagCostTarget Type) const
-	{
-		return Cast<T>(GetStatTagCostTarget(Type));
-	}
+	/**
+	 * Evaluates and caches the values of StatTagCosts at the specified level if not yet cached
+	 */
+	void CacheLevelValues(int32 AbilityLevel);
+
+	/**
+	 * Returns a copy of the values of the StatTagCosts entry at the specified level.
+	 * 
+	 * Note:
+	 *	Returned by value since the cache may grow while the caller uses it (e.g, another spec given while applying costs).
+	 *	If the level has not been cached, the curves are evaluated without caching.
+	 */
+	FStatTagCostLevelValues GetLevelValues(int32 AbilityLevel, int32 Index) const;
+
+	/**
+	 * Resolves the cost targets of the spec and stores them on the ability system component of the ActorInfo
+	 *
+	 * Note:
+	 *	Only called when the ability is given or the avatar is set, never while checking or applying costs.
+	 *	Not stored if the ability system component is not a UGAEAbilitySystemComponent.
+	 */
+	static FStatTagCostTargets StoreCostTargets(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec);
+
+	/**
+	 * Returns the cost targets of the spec stored on the ability system component of the ActorInfo
+	 *
+	 * Tips:
+	 *	If they are not stored or are out of date (e.g, the avatar has been possessed by another controller),
+	 *	they are resolved into OutResolvedTargets without being stored and it is returned instead.
+	 *	Nothing is written outside of OutResolvedTargets, so checking costs never modifies the state shared by the NonInstanced ability.
+	 */
+	static const FStatTagCostTargets& GetCostTargets(
+		FGameplayAbilitySpecHandle Handle
+		, const FGameplayAbilityActorInfo* ActorInfo
+		, FStatTagCostTargets& OutResolvedTargets);
 
 };
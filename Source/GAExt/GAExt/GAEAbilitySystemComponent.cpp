@@ -3,25 +3,92 @@
 #include "GAEAbilitySystemComponent.h"
 
 #include "AbilityTagRelationshipMapping.h"
+#include "AbilityCooldownTimerSubsystem.h"
+#include "Cost/AbilityCost.h"
 #include "GameplayTag/GAETags_Ability.h"
 #include "GameplayTag/GAETags_Flag.h"
 #include "GlobalAbilitySubsystem.h"
 #include "GAExtLogs.h"
+#include "GAExtStatGroup.h"
 
 #include "Player/GFCPlayerController.h"
 #include "InitState/InitStateTags.h"
 #include "InitState/InitStateComponent.h"
 
 #include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
 #include "Net/Core/PushModel/PushModel.h"
 #include "Components/GameFrameworkComponentManager.h"
 #include "GameFramework/Actor.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameplayEffect.h"
 #include "GameplayAbilitySpec.h"
+#include "AbilitySystemGlobals.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GAEAbilitySystemComponent)
 
 
+FAbilitySpecActivationFlags::FAbilitySpecActivationFlags(const UGameplayAbility* Ability)
+	: bIsGAEAbility(false), bUseCooldown(false), bHasCostEffect(false), bLocalPredicted(false), bCostChangeNotified(true), bCacheableActivationResult(true)
+{
+	bHasCostEffect = (Ability && Ability->GetCostGameplayEffect());
+	bLocalPredicted = (Ability && (Ability->GetNetExecutionPolicy() == EGameplayAbilityNetExecutionPolicy::LocalPredicted));
+
+	if (const auto* GAEAbility{ Cast<UGAEGameplayAbility>(Ability) })
+	{
+		ActivationMethod = GAEAbility->ActivationMethod;
+		ActivationPolicy = GAEAbility->ActivationPolicy;
+		bIsGAEAbility = true;
+		bUseCooldown = GAEAbility->bUseCooldown;
+		InputBufferWindow = GAEAbility->InputBufferWindow;
+
+		for (const auto& Cost : GAEAbility->AdditionalCosts)
+		{
+			if (Cost && !Cost->IsCostChangeNotified())
+			{
+				bCostChangeNotified = false;
+			}
+		}
+	}
+
+	bCacheableActivationResult = bCostChangeNotified;
+}
+
+
+static thread_local FAbilityActivationQueryContext* CurrentActivationQueryContext{ nullptr };
+
+FAbilityActivationQueryContext::FAbilityActivationQueryContext(const UAbilitySystemComponent* InASC)
+	: ASC(InASC)
+{
+	const auto& AbilitySystemGlobals{ UAbilitySystemGlobals::Get() };
+
+	bIgnoreCooldowns = AbilitySystemGlobals.ShouldIgnoreCooldowns();
+	bIgnoreCosts = AbilitySystemGlobals.ShouldIgnoreCosts();
+
+	OuterContext = CurrentActivationQueryContext;
+	CurrentActivationQueryContext = this;
+}
+
+FAbilityActivationQueryContext::~FAbilityActivationQueryContext()
+{
+	CurrentActivationQueryContext = OuterContext;
+}
+
+FAbilityActivationQueryContext* FAbilityActivationQueryContext::Get(const UAbilitySystemComponent* InASC)
+{
+	for (auto* Context{ CurrentActivationQueryContext }; Context; Context = Context->OuterContext)
+	{
+		if (Context->ASC == InASC)
+		{
+			return Context;
+		}
+	}
+
+	return nullptr;
+}
+
+
 const FName UGAEAbilitySystemComponent::NAME_ActorFeatureName("AbilitySystem");
 
 const FName UGAEAbilitySystemComponent::NAME_AbilityReady("AbilityReady");
@@ -29,6 +96,7 @@ const FName UGAEAbilitySystemComponent::NAME_AbilityReady("AbilityReady");
 UGAEAbilitySystemComponent::UGAEAbilitySystemComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	CooldownTimestamps.SetOwner(this);
 }
 
 void UGAEAbilitySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -40,6 +108,7 @@ void UGAEAbilitySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProp
 	Params.Condition = COND_None;
 
 	DOREPLIFETIME_WITH_PARAMS_FAST(UGAEAbilitySystemComponent, TagRelationshipMapping, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UGAEAbilitySystemComponent, CooldownTimestamps, Params);
 }
 
 
@@ -56,6 +125,20 @@ void UGAEAbilitySystemComponent::OnRegister()
 	// Register this component in the GameFrameworkComponentManager.
 
 	RegisterInitStateFeature();
+
+	// Listen for cooldowns of all abilities at once.
+
+	if (!OnActiveGameplayEffectAddedDelegateToSelf.IsBoundToObject(this))
+	{
+		OnActiveGameplayEffectAddedDelegateToSelf.AddUObject(this, &ThisClass::HandleCooldownEffectAdded);
+	}
+
+	// Listen for modifications of granted ability specs to keep the input tag index up to date.
+
+	if (!AbilitySpecDirtiedCallbacks.IsBoundToObject(this))
+	{
+		AbilitySpecDirtiedCallbacks.AddUObject(this, &ThisClass::HandleAbilitySpecDirtied);
+	}
 }
 
 void UGAEAbilitySystemComponent::BeginPlay()
@@ -99,6 +182,8 @@ void UGAEAbilitySystemComponent::InitAbilityActorInfo(AActor* InOwnerActor, AAct
 	
 	Super::InitAbilityActorInfo(InOwnerActor, InAvatarActor);
 
+	MarkActivationStateChanged();
+
 	if (InAvatarActor && IsOwnerActorAuthoritative())
 	{
 		// Register with the global system once we actually have a pawn avatar. 
@@ -117,7 +202,14 @@ void UGAEAbilitySystemComponent::InitAbilityActorInfo(AActor* InOwnerActor, AAct
 
 bool UGAEAbilitySystemComponent::GetShouldTick() const
 {
-	if (!InputHeldSpecHandles.IsEmpty())
+	if (InputEventQueueNum > 0)
+	{
+		return true;
+	}
+
+	// In event driven mode, held input abilities are retried by events and do not need ticking.
+
+	if (!bEventDrivenHeldInput && !InputHeldSpecHandles.IsEmpty())
 	{
 		return true;
 	}
@@ -129,7 +221,12 @@ void UGAEAbilitySystemComponent::TickComponent(float DeltaTime, ELevelTick TickT
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	ProcessHeldInput();
+	ProcessQueuedInputEvents();
+
+	if (!bEventDrivenHeldInput)
+	{
+		ProcessHeldInput();
+	}
 }
 
 
@@ -232,11 +329,32 @@ void UGAEAbilitySystemComponent::NotifyAbilityFailed(const FGameplayAbilitySpecH
 {
 	Super::NotifyAbilityFailed(Handle, Ability, FailureReason);
 
+	EAbilityActivateFailFlags FailureFlags;
+	const auto bCompact{ AbilityActivateFail::TagsToFlags(FailureReason, FailureFlags) };
+
+	LastFailedActivationHandle = Handle;
+	LastFailedActivationFlags = bCompact ? FailureFlags : EAbilityActivateFailFlags::None;
+
 	if (auto* PawnAvatar{ Cast<APawn>(GetAvatarActor()) })
 	{
 		if (!PawnAvatar->IsLocallyControlled() && Ability->IsSupportedForNetworking())
 		{
-			ClientNotifyAbilityFailed(Ability, FailureReason);
+			if (!ShouldNotifyAbilityFailed(Handle, FailureReason, bCompact, FailureFlags))
+			{
+				return;
+			}
+
+			// Send as flags if possible, as it is much smaller than the tag container
+
+			if (bCompact)
+			{
+				ClientNotifyAbilityFailedCompact(Ability, FailureFlags);
+			}
+			else
+			{
+				ClientNotifyAbilityFailed(Ability, FailureReason);
+			}
+
 			return;
 		}
 	}
@@ -244,17 +362,51 @@ void UGAEAbilitySystemComponent::NotifyAbilityFailed(const FGameplayAbilitySpecH
 	HandleAbilityFailed(Ability, FailureReason);
 }
 
-void UGAEAbilitySystemComponent::TryActivateAbilitiesOnSpawn()
+bool UGAEAbilitySystemComponent::ShouldNotifyAbilityFailed(const FGameplayAbilitySpecHandle& Handle, const FGameplayTagContainer& FailureReason, bool bCompact, EAbilityActivateFailFlags FailureFlags)
 {
-	ABILITYLIST_SCOPE_LOCK();
+	if (AbilityFailedNotifyInterval <= 0.0f)
+	{
+		return true;
+	}
 
-	for (const auto& AbilitySpec : ActivatableAbilities.Items)
+	// Only the retries of held input are repeated rapidly
+
+	const auto* Flags{ FindSpecActivationFlags(Handle) };
+
+	if (!Flags || (Flags->ActivationMethod != EAbilityActivationMethod::WhileInput))
+	{
+		return true;
+	}
+
+	auto* World{ GetWorld() };
+	if (!World)
 	{
-		if (const auto* GAEAbilityCDO{ Cast<UGAEGameplayAbility>(AbilitySpec.Ability) })
+		return true;
+	}
+
+	auto FailureReasonHash{ static_cast<uint32>(FailureFlags) };
+
+	if (!bCompact)
+	{
+		for (const auto& Tag : FailureReason)
 		{
-			GAEAbilityCDO->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), AbilitySpec);
+			FailureReasonHash = HashCombine(FailureReasonHash, GetTypeHash(Tag));
 		}
 	}
+
+	const auto CurrentTime{ World->GetTimeSeconds() };
+
+	auto& Record{ AbilityFailureNotifyRecords.FindOrAdd(Handle) };
+
+	if ((Record.LastNotifyTime > 0.0) && (Record.FailureReasonHash == FailureReasonHash) && ((CurrentTime - Record.LastNotifyTime) < AbilityFailedNotifyInterval))
+	{
+		return false;
+	}
+
+	Record.LastNotifyTime = CurrentTime;
+	Record.FailureReasonHash = FailureReasonHash;
+
+	return true;
 }
 
 void UGAEAbilitySystemComponent::ClientNotifyAbilityFailed_Implementation(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason)
@@ -262,6 +414,14 @@ void UGAEAbilitySystemComponent::ClientNotifyAbilityFailed_Implementation(const
 	HandleAbilityFailed(Ability, FailureReason);
 }
 
+void UGAEAbilitySystemComponent::ClientNotifyAbilityFailedCompact_Implementation(const UGameplayAbility* Ability, EAbilityActivateFailFlags FailureFlags)
+{
+	FGameplayTagContainer FailureReason;
+	AbilityActivateFail::FlagsToTags(FailureFlags, FailureReason);
+
+	HandleAbilityFailed(Ability, FailureReason);
+}
+
 void UGAEAbilitySystemComponent::HandleAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason)
 {
 	if (const auto* GAEAbility{ Cast<const UGAEGameplayAbility>(Ability) })
@@ -274,46 +434,72 @@ void UGAEAbilitySystemComponent::CancelAbilitiesByFunc(TShouldCancelAbilityFunc
 {
 	ABILITYLIST_SCOPE_LOCK();
 
-	for (const auto& AbilitySpec : ActivatableAbilities.Items)
+	PruneActiveSpecEntries();
+
+	// Copy the entries, since canceling abilities modifies them.
+	// Specs are not removed from ActivatableAbilities while the ability list is locked.
+
+	const TArray<FAbilitySpecIndexEntry, TInlineAllocator<4>> Entries{ ActiveSpecEntries };
+
+	for (const auto& Entry : Entries)
 	{
+		auto* AbilitySpec{ ActivatableAbilities.Items.IsValidIndex(Entry.SpecIndexHint) ? &ActivatableAbilities.Items[Entry.SpecIndexHint] : nullptr };
+
 		// Skip if not active.
 
-		if (!AbilitySpec.IsActive())
+		if (!AbilitySpec || (AbilitySpec->Handle != Entry.Handle) || !AbilitySpec->IsActive())
 		{
 			continue;
 		}
 
-		const auto& AbilityCDO{ AbilitySpec.Ability };
+		const auto& AbilityCDO{ AbilitySpec->Ability };
 
 		// Cancel all the spawned instances, not the CDO.
 
 		if (AbilityCDO->GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
 		{
-			auto Instances{ AbilitySpec.GetAbilityInstances() };
+			// Walk the instance arrays directly instead of copying them.
+			// Iterate backwards since instanced per execution abilities are removed from them when they end.
 
-			for (const auto& AbilityInstance : Instances)
+			auto CancelInstances
 			{
-				if (ShouldCancelFunc(AbilityInstance, AbilitySpec.Handle))
+				[&](const TArray<TObjectPtr<UGameplayAbility>>& Instances)
 				{
-					if (AbilityInstance->CanBeCanceled())
-					{
-						AbilityInstance->CancelAbility(AbilitySpec.Handle, AbilityActorInfo.Get(), AbilityInstance->GetCurrentActivationInfo(), bReplicateCancelAbility);
-					}
-					else
+					for (auto Index{ Instances.Num() - 1 }; Index >= 0; --Index)
 					{
-						UE_LOG(LogGameExt_Ability, Error, TEXT("CancelAbilitiesByFunc: Can't cancel ability [%s] because CanBeCanceled is false."), *GetNameSafe(AbilityInstance));
+						if (!Instances.IsValidIndex(Index))
+						{
+							continue;
+						}
+
+						UGameplayAbility* AbilityInstance{ Instances[Index] };
+
+						if (AbilityInstance && ShouldCancelFunc(AbilityInstance, AbilitySpec->Handle))
+						{
+							if (AbilityInstance->CanBeCanceled())
+							{
+								AbilityInstance->CancelAbility(AbilitySpec->Handle, AbilityActorInfo.Get(), AbilityInstance->GetCurrentActivationInfo(), bReplicateCancelAbility);
+							}
+							else
+							{
+								UE_LOG(LogGameExt_Ability, Error, TEXT("CancelAbilitiesByFunc: Can't cancel ability [%s] because CanBeCanceled is false."), *GetNameSafe(AbilityInstance));
+							}
+						}
 					}
 				}
-			}
+			};
+
+			CancelInstances(AbilitySpec->ReplicatedInstances);
+			CancelInstances(AbilitySpec->NonReplicatedInstances);
 		}
 
 		// Cancel the non-instanced ability CDO.
 
-		else if (ShouldCancelFunc(AbilityCDO, AbilitySpec.Handle))
+		else if (ShouldCancelFunc(AbilityCDO, AbilitySpec->Handle))
 		{
 			if (AbilityCDO->CanBeCanceled())
 			{
-				AbilityCDO->CancelAbility(AbilitySpec.Handle, AbilityActorInfo.Get(), FGameplayAbilityActivationInfo(), bReplicateCancelAbility);
+				AbilityCDO->CancelAbility(AbilitySpec->Handle, AbilityActorInfo.Get(), FGameplayAbilityActivationInfo(), bReplicateCancelAbility);
 			}
 			else
 			{
@@ -323,165 +509,1644 @@ void UGAEAbilitySystemComponent::CancelAbilitiesByFunc(TShouldCancelAbilityFunc
 	}
 }
 
+void UGAEAbilitySystemComponent::GetActiveAbilitySpecHandles(TArray<FGameplayAbilitySpecHandle>& OutHandles)
+{
+	PruneActiveSpecEntries();
 
-void UGAEAbilitySystemComponent::ApplyAbilityBlockAndCancelTags(const FGameplayTagContainer& AbilityTags, UGameplayAbility* RequestingAbility, bool bEnableBlockTags, const FGameplayTagContainer& BlockTags, bool bExecuteCancelTags, const FGameplayTagContainer& CancelTags)
+	for (const auto& Entry : ActiveSpecEntries)
+	{
+		OutHandles.Add(Entry.Handle);
+	}
+}
+
+void UGAEAbilitySystemComponent::QueryActivatableAbilities(TArray<FAbilityActivationQueryResult>& OutResults, TBitArray<>* OutActivatableMask)
 {
-	auto ModifiedBlockTags{ BlockTags };
-	auto ModifiedCancelTags{ CancelTags };
+	OutResults.Reset();
 
-	// Use the mapping to expand the ability tags into block and cancel tag
+	if (OutActivatableMask)
+	{
+		OutActivatableMask->Reset();
+	}
 
-	if (TagRelationshipMapping)
+	const auto* ActorInfo{ AbilityActorInfo.Get() };
+
+	if (!ActorInfo)
 	{
-		TagRelationshipMapping->GetAbilityTagsToBlockAndCancel(AbilityTags, &ModifiedBlockTags, &ModifiedCancelTags);
+		return;
 	}
 
-	Super::ApplyAbilityBlockAndCancelTags(AbilityTags, RequestingAbility, bEnableBlockTags, ModifiedBlockTags, bExecuteCancelTags, ModifiedCancelTags);
-}
+	ABILITYLIST_SCOPE_LOCK();
 
-void UGAEAbilitySystemComponent::SetTagRelationshipMapping(const UAbilityTagRelationshipMapping* NewMapping)
-{
-	if (GetOwner()->HasAuthority())
+	// Nothing changes the owned tags or the cost targets during the pass, so the checks share what they read.
+
+	FAbilityActivationQueryContext QueryContext{ this };
+
+	FGameplayTagContainer FailureTags;
+
+	for (const auto& AbilitySpec : ActivatableAbilities.Items)
 	{
-		if (TagRelationshipMapping != NewMapping)
+		if (!AbilitySpec.Ability || !GetSpecActivationFlags(AbilitySpec).bIsGAEAbility)
 		{
-			TagRelationshipMapping = NewMapping;
+			continue;
+		}
 
-			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, TagRelationshipMapping, this);
+		auto& Result{ OutResults.AddDefaulted_GetRef() };
+
+		EvaluateActivationQuery(AbilitySpec, FailureTags, Result);
+
+		if (OutActivatableMask)
+		{
+			OutActivatableMask->Add(Result.bCanActivate);
 		}
 	}
 }
 
-void UGAEAbilitySystemComponent::GetAdditionalActivationTagRequirements(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer& OutActivationRequired, FGameplayTagContainer& OutActivationBlocked) const
+void UGAEAbilitySystemComponent::BP_QueryActivatableAbilities(TArray<FAbilityActivationQueryResult>& OutResults)
 {
-	if (TagRelationshipMapping)
-	{
-		TagRelationshipMapping->GetRequiredAndBlockedActivationTags(AbilityTags, &OutActivationRequired, &OutActivationBlocked);
-	}
+	QueryActivatableAbilities(OutResults);
 }
 
-
-void UGAEAbilitySystemComponent::AbilitySpecInputPressed(FGameplayAbilitySpec& Spec)
+bool UGAEAbilitySystemComponent::QueryCanActivateAbility(const FGameplayAbilitySpecHandle& Handle, EAbilityActivateFailFlags* OutFailureFlags)
 {
-	Super::AbilitySpecInputPressed(Spec);
+	// Look up the cache first so that a cached result does not need to search the spec.
 
-	// We don't support UGameplayAbility::bReplicateInputDirectly.
-	// Use replicated events instead so that the WaitInputPress ability task works.
+	auto Result{ FAbilityActivationQueryResult() };
 
-	if (Spec.IsActive())
+	if (const auto* CachedResult{ FindCachedActivationQueryResult(Handle) })
 	{
-		// Invoke the InputPressed event. This is not replicated here. If someone is listening, they may replicate the InputPressed event to the server.
+		Result = *CachedResult;
+	}
+	else
+	{
+		const auto* AbilitySpec{ FindAbilitySpecFromHandle(Handle) };
 
-		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputPressed, Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+		if (!AbilitySpec || !AbilitySpec->Ability || !AbilityActorInfo.IsValid() || !GetSpecActivationFlags(*AbilitySpec).bIsGAEAbility)
+		{
+			return false;
+		}
+
+		ABILITYLIST_SCOPE_LOCK();
+
+		FAbilityActivationQueryContext QueryContext{ this };
+
+		FGameplayTagContainer FailureTags;
+
+		EvaluateActivationQuery(*AbilitySpec, FailureTags, Result);
 	}
+
+	if (OutFailureFlags)
+	{
+		*OutFailureFlags = Result.GetFailureFlags();
+	}
+
+	return Result.bCanActivate;
 }
 
-void UGAEAbilitySystemComponent::AbilitySpecInputReleased(FGameplayAbilitySpec& Spec)
+void UGAEAbilitySystemComponent::EvaluateActivationQuery(const FGameplayAbilitySpec& AbilitySpec, FGameplayTagContainer& FailureTags, FAbilityActivationQueryResult& OutResult)
 {
-	Super::AbilitySpecInputReleased(Spec);
+	if (const auto* CachedResult{ FindCachedActivationQueryResult(AbilitySpec.Handle) })
+	{
+		OutResult = *CachedResult;
+		return;
+	}
 
-	// We don't support UGameplayAbility::bReplicateInputDirectly.
-	// Use replicated events instead so that the WaitInputRelease ability task works.
+	// Check on the instance if there is one, same as activation does.
 
-	if (Spec.IsActive())
+	auto* PrimaryInstance{ AbilitySpec.GetPrimaryInstance() };
+	auto* Ability{ PrimaryInstance ? PrimaryInstance : AbilitySpec.Ability.Get() };
+
+	FailureTags.Reset();
+
+	OutResult.Handle = AbilitySpec.Handle;
+	OutResult.Ability = CastChecked<UGAEGameplayAbility>(Ability);
+	OutResult.bCanActivate = Ability->CanActivateAbility(AbilitySpec.Handle, AbilityActorInfo.Get(), nullptr, nullptr, &FailureTags);
+	auto FailureFlags{ EAbilityActivateFailFlags::None };
+
+	if (!OutResult.bCanActivate)
 	{
-		// Invoke the InputReleased event. This is not replicated here. If someone is listening, they may replicate the InputReleased event to the server.
+		AbilityActivateFail::TagsToFlags(FailureTags, FailureFlags);
+	}
 
-		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputReleased, Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+	OutResult.SetFailureFlags(FailureFlags);
+
+	if (bCacheActivationQueryResults && GetSpecActivationFlags(AbilitySpec).bCacheableActivationResult)
+	{
+		ActivationQueryResultCache.Add(AbilitySpec.Handle, MakeTuple(ActivationStateGeneration, OutResult));
 	}
 }
 
-void UGAEAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
+const FAbilityActivationQueryResult* UGAEAbilitySystemComponent::FindCachedActivationQueryResult(const FGameplayAbilitySpecHandle& Handle) const
 {
-	if (InputTag.IsValid())
+	if (bCacheActivationQueryResults)
 	{
-		for (auto& AbilitySpec : ActivatableAbilities.Items)
+		if (const auto* CachedEntry{ ActivationQueryResultCache.Find(Handle) })
 		{
-			if (AbilitySpec.Ability && (AbilitySpec.DynamicAbilityTags.HasTagExact(InputTag)))
+			if (CachedEntry->Key == ActivationStateGeneration)
 			{
-				AbilitySpec.InputPressed = true;
+				return &CachedEntry->Value;
+			}
+		}
+	}
 
-				if (AbilitySpec.IsActive())
-				{
-					// Ability is active so pass along the input event.
+	return nullptr;
+}
 
-					AbilitySpecInputPressed(AbilitySpec);
-				}
+void UGAEAbilitySystemComponent::SetUserAbilityActivationInhibited(bool NewInhibit)
+{
+	Super::SetUserAbilityActivationInhibited(NewInhibit);
 
-				if (auto* GAEAbility{ Cast<UGAEGameplayAbility>(AbilitySpec.Ability) })
-				{
-					if (GAEAbility->ActivationMethod == EAbilityActivationMethod::OnInputTriggered)
-					{
-						TryActivateAbility(AbilitySpec.Handle);
-					}
-					else if (GAEAbility->ActivationMethod == EAbilityActivationMethod::WhileInput)
-					{
-						TryActivateAbility(AbilitySpec.Handle);
+	MarkActivationStateChanged();
+}
 
-						InputHeldSpecHandles.AddUnique(AbilitySpec.Handle);
-					}
-				}
-			}
-		}
+void UGAEAbilitySystemComponent::NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability)
+{
+	Super::NotifyAbilityActivated(Handle, Ability);
+
+	MarkActivationStateChanged();
+
+	const auto bAlreadyListed
+	{
+		ActiveSpecEntries.ContainsByPredicate([&Handle](const FAbilitySpecIndexEntry& Entry) { return Entry.Handle == Handle; })
+	};
+
+	if (!bAlreadyListed)
+	{
+		ActiveSpecEntries.Emplace(Handle, INDEX_NONE);
 	}
 }
 
-void UGAEAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& InputTag)
+void UGAEAbilitySystemComponent::PruneActiveSpecEntries()
 {
-	if (InputTag.IsValid())
+	for (auto Index{ ActiveSpecEntries.Num() - 1 }; Index >= 0; --Index)
 	{
-		for (auto& AbilitySpec : ActivatableAbilities.Items)
+		auto& Entry{ ActiveSpecEntries[Index] };
+
+		const auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) };
+
+		if (!AbilitySpec || !AbilitySpec->IsActive())
 		{
-			if (AbilitySpec.Ability && (AbilitySpec.DynamicAbilityTags.HasTagExact(InputTag)))
-			{
-				AbilitySpec.InputPressed = false;
+			ActiveSpecEntries.RemoveAtSwap(Index, 1, false);
+		}
+	}
+}
 
-				if (AbilitySpec.IsActive())
-				{
-					// Ability is active so pass along the input event.
 
-					AbilitySpecInputReleased(AbilitySpec);
-				}
+void UGAEAbilitySystemComponent::TryActivateAbilitiesOnSpawn()
+{
+	ABILITYLIST_SCOPE_LOCK();
 
-				InputHeldSpecHandles.Remove(AbilitySpec.Handle);
-			}
+	// All "OnSpawn" abilities are tried here, including the pending ones.
+	// Grants and removals are deferred while the ability list is locked, so the entries are not modified during the loop.
+
+	PendingOnSpawnSpecEntries.Reset();
+
+	for (auto& Entry : OnSpawnSpecEntries)
+	{
+		if (const auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) })
+		{
+			TryActivateSpecOnSpawn(*AbilitySpec);
 		}
 	}
 }
 
-void UGAEAbilitySystemComponent::ProcessHeldInput()
+void UGAEAbilitySystemComponent::TryActivateSpecOnSpawn(const FGameplayAbilitySpec& Spec)
 {
-	for (const auto& SpecHandle : InputHeldSpecHandles)
+	if (const auto* GAEAbilityCDO{ Cast<UGAEGameplayAbility>(Spec.Ability) })
 	{
-		if (const auto* AbilitySpec{ FindAbilitySpecFromHandle(SpecHandle) })
+		GAEAbilityCDO->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), Spec);
+	}
+}
+
+void UGAEAbilitySystemComponent::TryActivatePendingAbilitiesOnSpawn()
+{
+	if (PendingOnSpawnSpecEntries.IsEmpty())
+	{
+		return;
+	}
+
+	ABILITYLIST_SCOPE_LOCK();
+
+	auto Entries{ MoveTemp(PendingOnSpawnSpecEntries) };
+	PendingOnSpawnSpecEntries.Reset();
+
+	for (auto& Entry : Entries)
+	{
+		if (const auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) })
 		{
-			if (AbilitySpec->Ability && !AbilitySpec->IsActive())
-			{
-				if (auto* GAEAbility{ Cast<UGAEGameplayAbility>(AbilitySpec->Ability) })
-				{
-					if (GAEAbility->ActivationMethod == EAbilityActivationMethod::WhileInput)
-					{
-						TryActivateAbility(AbilitySpec->Handle);
-					}
-				}
-			}
+			TryActivateSpecOnSpawn(*AbilitySpec);
 		}
 	}
 }
 
-void UGAEAbilitySystemComponent::CancelInputActivatedAbilities(bool bReplicateCancelAbility)
+void UGAEAbilitySystemComponent::BeginDeferOnSpawnActivation()
 {
-	TShouldCancelAbilityFunc ShouldCancelFunc = [this](const UGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
+	++OnSpawnActivationDeferralCount;
+}
+
+void UGAEAbilitySystemComponent::EndDeferOnSpawnActivation()
+{
+	if (ensure(OnSpawnActivationDeferralCount > 0))
 	{
-		if (auto* GAEAbility{ Cast<UGAEGameplayAbility>(Ability) })
-		{
-			const auto ActivationMethod{ GAEAbility->ActivationMethod };
+		--OnSpawnActivationDeferralCount;
+	}
 
-			return (ActivationMethod == EAbilityActivationMethod::OnInputTriggered);
-		}
+	if (OnSpawnActivationDeferralCount == 0)
+	{
+		TryActivatePendingAbilitiesOnSpawn();
+	}
+}
 
-		return false;
-	};
 
-	CancelAbilitiesByFunc(ShouldCancelFunc, bReplicateCancelAbility);
+void UGAEAbilitySystemComponent::ApplyAbilityBlockAndCancelTags(const FGameplayTagContainer& AbilityTags, UGameplayAbility* RequestingAbility, bool bEnableBlockTags, const FGameplayTagContainer& BlockTags, bool bExecuteCancelTags, const FGameplayTagContainer& CancelTags)
+{
+	auto ModifiedBlockTags{ BlockTags };
+	auto ModifiedCancelTags{ CancelTags };
+
+	// Use the mapping to expand the ability tags into block and cancel tag
+
+	if (TagRelationshipMapping)
+	{
+		// Use the precompiled ability tag bits if the tags are the ones of the requesting ability
+
+		const auto* GAEAbility{ Cast<UGAEGameplayAbility>(RequestingAbility) };
+		const auto* Requirements{ (bUseTagBitSets && GAEAbility && (&AbilityTags == &GAEAbility->AbilityTags)) ? &GetActivationTagRequirements(*GAEAbility) : nullptr };
+
+		if (Requirements && Requirements->bTagBitsValid)
+		{
+			TagRelationshipMapping->GetAbilityTagsToBlockAndCancel(Requirements->AbilityTagBits, &ModifiedBlockTags, &ModifiedCancelTags);
+		}
+		else
+		{
+			TagRelationshipMapping->GetAbilityTagsToBlockAndCancel(AbilityTags, &ModifiedBlockTags, &ModifiedCancelTags);
+		}
+	}
+
+	Super::ApplyAbilityBlockAndCancelTags(AbilityTags, RequestingAbility, bEnableBlockTags, ModifiedBlockTags, bExecuteCancelTags, ModifiedCancelTags);
+}
+
+void UGAEAbilitySystemComponent::SetTagRelationshipMapping(const UAbilityTagRelationshipMapping* NewMapping)
+{
+	if (GetOwner()->HasAuthority())
+	{
+		if (TagRelationshipMapping != NewMapping)
+		{
+			TagRelationshipMapping = NewMapping;
+
+			MarkActivationStateChanged();
+
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, TagRelationshipMapping, this);
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::GetAdditionalActivationTagRequirements(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer& OutActivationRequired, FGameplayTagContainer& OutActivationBlocked) const
+{
+	if (TagRelationshipMapping)
+	{
+		TagRelationshipMapping->GetRequiredAndBlockedActivationTags(AbilityTags, &OutActivationRequired, &OutActivationBlocked);
+	}
+}
+
+const FAbilityActivationTagRequirements& UGAEAbilitySystemComponent::GetActivationTagRequirements(const UGAEGameplayAbility& Ability) const
+{
+	// The mapping is also changed by replication on clients, so it is a part of the key instead of resetting the cache
+
+	const auto* Mapping{ TagRelationshipMapping.Get() };
+	const auto Key{ MakeTuple(TObjectKey<UAbilityTagRelationshipMapping>(Mapping), TObjectKey<UClass>(Ability.GetClass())) };
+
+	{
+		FReadScopeLock ReadLock{ ActivationTagRequirementsCacheLock };
+
+		if (const auto* Requirements{ ActivationTagRequirementsCache.Find(Key) })
+		{
+			return **Requirements;
+		}
+	}
+
+	FWriteScopeLock WriteLock{ ActivationTagRequirementsCacheLock };
+
+	// Another thread may have added it while waiting for the lock
+
+	if (const auto* Requirements{ ActivationTagRequirementsCache.Find(Key) })
+	{
+		return **Requirements;
+	}
+
+	auto Requirements{ MakeUnique<FAbilityActivationTagRequirements>() };
+	Requirements->RequiredTags = Ability.ActivationRequiredTags;
+	Requirements->BlockedTags = Ability.ActivationBlockedTags;
+
+	if (Mapping)
+	{
+		Mapping->GetRequiredAndBlockedActivationTags(Ability.AbilityTags, &Requirements->RequiredTags, &Requirements->BlockedTags);
+	}
+
+	auto bTagBitsValid{ Requirements->AbilityTagBits.AddTags(Ability.AbilityTags, true) };
+	bTagBitsValid &= Requirements->RequiredTagBits.AddTags(Requirements->RequiredTags, false);
+	bTagBitsValid &= Requirements->BlockedTagBits.AddTags(Requirements->BlockedTags, false);
+
+	Requirements->bTagBitsValid = bTagBitsValid;
+
+	return *ActivationTagRequirementsCache.Add(Key, MoveTemp(Requirements));
+}
+
+void UGAEAbilitySystemComponent::BlockAbilitiesWithTags(const FGameplayTagContainer& Tags)
+{
+	Super::BlockAbilitiesWithTags(Tags);
+
+	MarkActivationStateChanged();
+
+	if (bUseTagBitSets)
+	{
+		RebuildBlockedAbilityTagBits();
+	}
+}
+
+void UGAEAbilitySystemComponent::UnBlockAbilitiesWithTags(const FGameplayTagContainer& Tags)
+{
+	Super::UnBlockAbilitiesWithTags(Tags);
+
+	MarkActivationStateChanged();
+
+	if (bUseTagBitSets)
+	{
+		RebuildBlockedAbilityTagBits();
+	}
+
+	// Abilities blocked by the tags may be activatable now.
+
+	WakeParkedActivations(EAbilityActivateFailFlags::TagsBlocked);
+
+	RequestInputRetry();
+}
+
+void UGAEAbilitySystemComponent::UpdateOwnedTagBits(const FGameplayTag& Tag)
+{
+	// Tag counts include the counts of child tags, so parent tags are owned as long as any child is.
+
+	for (auto Current{ Tag }; Current.IsValid(); Current = Current.RequestDirectParent())
+	{
+		OwnedTagBits.SetTag(Current, (GetTagCount(Current) > 0));
+	}
+}
+
+void UGAEAbilitySystemComponent::RebuildBlockedAbilityTagBits()
+{
+	BlockedAbilityTagBits.Reset();
+
+	bBlockedAbilityTagBitsValid = BlockedAbilityTagBits.AddTags(BlockedAbilityTags.GetExplicitGameplayTags(), false);
+}
+
+
+void UGAEAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	if (AbilitySpec.Ability)
+	{
+		SpecActivationFlags.Add(AbilitySpec.Handle, FAbilitySpecActivationFlags(AbilitySpec.Ability)).Level = AbilitySpec.Level;
+	}
+
+	Super::OnGiveAbility(AbilitySpec);
+
+	MarkActivationStateChanged();
+
+	ObserveCostAttributes(AbilitySpec.Ability);
+
+	AddSpecToInputTagIndex(AbilitySpec);
+
+	const auto* Flags{ FindSpecActivationFlags(AbilitySpec.Handle) };
+
+	const auto& Items{ ActivatableAbilities.Items };
+	const auto SpecIndex{ static_cast<int32>(&AbilitySpec - Items.GetData()) };
+	const auto SpecIndexHint{ Items.IsValidIndex(SpecIndex) ? SpecIndex : INDEX_NONE };
+
+	if (Flags && Flags->bIsGAEAbility && Flags->bUseCooldown)
+	{
+		CooldownSpecEntries.FindOrAdd(AbilitySpec.Ability.Get()).Emplace(AbilitySpec.Handle, SpecIndexHint);
+	}
+
+	if (Flags && Flags->bIsGAEAbility && (Flags->ActivationMethod == EAbilityActivationMethod::OnSpawn))
+	{
+		OnSpawnSpecEntries.Emplace(AbilitySpec.Handle, SpecIndexHint);
+		PendingOnSpawnSpecEntries.Emplace(AbilitySpec.Handle, SpecIndexHint);
+
+		if (OnSpawnActivationDeferralCount == 0)
+		{
+			TryActivatePendingAbilitiesOnSpawn();
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	// Removal swaps the last spec into the removed slot, so the index is rebuilt on next use.
+
+	MarkInputTagIndexDirty();
+
+	InputHeldSpecHandles.Remove(AbilitySpec.Handle);
+	RemoveBufferedInput(AbilitySpec.Handle);
+	ParkedActivations.Remove(AbilitySpec.Handle);
+
+	Super::OnRemoveAbility(AbilitySpec);
+
+	auto MatchesHandle{ [&AbilitySpec](const FAbilitySpecIndexEntry& Entry) { return Entry.Handle == AbilitySpec.Handle; } };
+
+	ActiveSpecEntries.RemoveAllSwap(MatchesHandle, false);
+	OnSpawnSpecEntries.RemoveAllSwap(MatchesHandle, false);
+	PendingOnSpawnSpecEntries.RemoveAllSwap(MatchesHandle, false);
+	SpecActivationFlags.Remove(AbilitySpec.Handle);
+	AbilityFailureNotifyRecords.Remove(AbilitySpec.Handle);
+	ActivationQueryResultCache.Remove(AbilitySpec.Handle);
+	SpecCooldownStates.Remove(AbilitySpec.Handle);
+	SpecStatTagCostTargets.Remove(AbilitySpec.Handle);
+
+	if (IsOwnerActorAuthoritative() && CooldownTimestamps.Remove(AbilitySpec.Handle))
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CooldownTimestamps, this);
+
+		ScheduleTimestampCooldownTimer();
+	}
+
+	if (auto* Entries{ CooldownSpecEntries.Find(AbilitySpec.Ability.Get()) })
+	{
+		Entries->RemoveAllSwap(MatchesHandle, false);
+
+		if (Entries->IsEmpty())
+		{
+			CooldownSpecEntries.Remove(AbilitySpec.Ability.Get());
+		}
+	}
+
+	MarkActivationStateChanged();
+}
+
+void UGAEAbilitySystemComponent::OnRep_ActivateAbilities()
+{
+	// Replicated specs may have changed their DynamicAbilityTags or their order.
+
+	MarkInputTagIndexDirty();
+	MarkActivationStateChanged();
+
+	// Activate "OnSpawn" abilities of newly replicated specs in a single pass.
+
+	FScopedOnSpawnActivationDeferral OnSpawnActivationDeferral{ this };
+
+	Super::OnRep_ActivateAbilities();
+
+	// Replicated specs may have changed their level
+
+	for (const auto& Spec : ActivatableAbilities.Items)
+	{
+		UpdateSpecLevel(Spec);
+	}
+}
+
+
+void UGAEAbilitySystemComponent::AbilitySpecInputPressed(FGameplayAbilitySpec& Spec)
+{
+	Super::AbilitySpecInputPressed(Spec);
+
+	// We don't support UGameplayAbility::bReplicateInputDirectly.
+	// Use replicated events instead so that the WaitInputPress ability task works.
+
+	if (Spec.IsActive())
+	{
+		// Invoke the InputPressed event. This is not replicated here. If someone is listening, they may replicate the InputPressed event to the server.
+
+		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputPressed, Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+	}
+}
+
+void UGAEAbilitySystemComponent::AbilitySpecInputReleased(FGameplayAbilitySpec& Spec)
+{
+	Super::AbilitySpecInputReleased(Spec);
+
+	// We don't support UGameplayAbility::bReplicateInputDirectly.
+	// Use replicated events instead so that the WaitInputRelease ability task works.
+
+	if (Spec.IsActive())
+	{
+		// Invoke the InputReleased event. This is not replicated here. If someone is listening, they may replicate the InputReleased event to the server.
+
+		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputReleased, Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+	}
+}
+
+void UGAEAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
+{
+	if (InputTag.IsValid())
+	{
+		if (bQueueInputEvents)
+		{
+			EnqueueInputEvent(InputTag, true);
+		}
+		else
+		{
+			ProcessInputTagPressed(InputTag, nullptr);
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& InputTag)
+{
+	if (InputTag.IsValid())
+	{
+		if (bQueueInputEvents)
+		{
+			EnqueueInputEvent(InputTag, false);
+		}
+		else
+		{
+			ProcessInputTagReleased(InputTag);
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::ProcessInputTagPressed(const FGameplayTag& InputTag, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>>* InOutActivatedHandles)
+{
+	// Copy the bound handles, since activation may grant or remove abilities and modify the index.
+
+	TArray<FAbilitySpecIndexEntry, TInlineAllocator<8>> Entries;
+	GetSpecHandlesForInputTag(InputTag, Entries);
+
+	// Abilities bound to the same input tag are activated on the server with a single RPC.
+
+	BeginServerActivationBatch();
+
+	for (auto& Entry : Entries)
+	{
+		auto* AbilitySpec{ FindInputTagIndexedSpec(Entry) };
+
+		if (AbilitySpec && AbilitySpec->Ability && (AbilitySpec->DynamicAbilityTags.HasTagExact(InputTag)))
+		{
+			const auto bAlreadyActivated{ InOutActivatedHandles && InOutActivatedHandles->Contains(Entry.Handle) };
+
+			// Skip duplicate presses of the same ability in the same batch
+
+			if (bAlreadyActivated && AbilitySpec->InputPressed)
+			{
+				continue;
+			}
+
+			AbilitySpec->InputPressed = true;
+
+			if (AbilitySpec->IsActive())
+			{
+				// Ability is active so pass along the input event.
+
+				AbilitySpecInputPressed(*AbilitySpec);
+			}
+
+			// Copy the settings, since activation may grant abilities and invalidate the spec and the flags.
+
+			const auto Flags{ GetSpecActivationFlags(*AbilitySpec) };
+			const auto ActivationMethod{ Flags.ActivationMethod };
+
+			if (ActivationMethod == EAbilityActivationMethod::WhileInput)
+			{
+				InputHeldSpecHandles.AddUnique(Entry.Handle);
+			}
+
+			if (!bAlreadyActivated)
+			{
+				if ((ActivationMethod == EAbilityActivationMethod::OnInputTriggered) || (ActivationMethod == EAbilityActivationMethod::WhileInput))
+				{
+					const auto bActivated{ TryActivatePendingAbility(Entry.Handle) };
+
+					// Keep the press to replay it when the condition blocking the ability clears.
+
+					if (ActivationMethod == EAbilityActivationMethod::OnInputTriggered)
+					{
+						auto* World{ GetWorld() };
+
+						if (!bActivated && (Flags.InputBufferWindow > 0.0f) && World)
+						{
+							BufferInput(FAbilityBufferedInput(Entry.Handle, InputTag, World->GetTimeSeconds() + Flags.InputBufferWindow));
+						}
+						else if (bActivated)
+						{
+							RemoveBufferedInput(Entry.Handle);
+						}
+					}
+
+					if (InOutActivatedHandles)
+					{
+						InOutActivatedHandles->Add(Entry.Handle);
+					}
+				}
+			}
+		}
+	}
+
+	EndServerActivationBatch();
+}
+
+void UGAEAbilitySystemComponent::ProcessInputTagReleased(const FGameplayTag& InputTag)
+{
+	TArray<FAbilitySpecIndexEntry, TInlineAllocator<8>> Entries;
+	GetSpecHandlesForInputTag(InputTag, Entries);
+
+	for (auto& Entry : Entries)
+	{
+		auto* AbilitySpec{ FindInputTagIndexedSpec(Entry) };
+
+		if (AbilitySpec && AbilitySpec->Ability && (AbilitySpec->DynamicAbilityTags.HasTagExact(InputTag)))
+		{
+			AbilitySpec->InputPressed = false;
+
+			if (AbilitySpec->IsActive())
+			{
+				// Ability is active so pass along the input event.
+
+				AbilitySpecInputReleased(*AbilitySpec);
+			}
+
+			InputHeldSpecHandles.Remove(Entry.Handle);
+			ParkedActivations.Remove(Entry.Handle);
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::EnqueueInputEvent(const FGameplayTag& InputTag, bool bPressed)
+{
+	// If the queue is full, process what has been queued so far to keep the order of events.
+
+	if (InputEventQueueNum >= InputEventQueueSize)
+	{
+		ProcessQueuedInputEvents();
+	}
+
+	const auto Index{ (InputEventQueueHead + InputEventQueueNum) % InputEventQueueSize };
+	InputEventQueue[Index] = FAbilityQueuedInputEvent(InputTag, bPressed);
+
+	++InputEventQueueNum;
+
+	// Make sure the queue is processed on the next tick even if nothing else keeps this component ticking
+
+	UpdateShouldTick();
+}
+
+void UGAEAbilitySystemComponent::ProcessQueuedInputEvents()
+{
+	if (InputEventQueueNum <= 0)
+	{
+		return;
+	}
+
+	ABILITYLIST_SCOPE_LOCK();
+
+	BeginServerActivationBatch();
+
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> ActivatedHandles;
+
+	// Events queued while processing (e.g, from an ability activation) are processed in this same pass.
+
+	while (InputEventQueueNum > 0)
+	{
+		const auto Event{ InputEventQueue[InputEventQueueHead] };
+
+		InputEventQueueHead = (InputEventQueueHead + 1) % InputEventQueueSize;
+		--InputEventQueueNum;
+
+		if (Event.bPressed)
+		{
+			ProcessInputTagPressed(Event.InputTag, &ActivatedHandles);
+		}
+		else
+		{
+			ProcessInputTagReleased(Event.InputTag);
+		}
+	}
+
+	InputEventQueueHead = 0;
+
+	EndServerActivationBatch();
+}
+
+void UGAEAbilitySystemComponent::ProcessHeldInput()
+{
+	// Copy the handles, since activation may remove abilities and modify the held handles.
+
+	const TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> SpecHandles{ InputHeldSpecHandles };
+
+	auto bUnparkedFailure{ false };
+
+	BeginServerActivationBatch();
+
+	for (const auto& SpecHandle : SpecHandles)
+	{
+		// Skip abilities waiting for the condition blocking them to clear
+
+		if (IsActivationParked(SpecHandle))
+		{
+			continue;
+		}
+
+		if (const auto* AbilitySpec{ FindAbilitySpecFromHandle(SpecHandle) })
+		{
+			if (AbilitySpec->Ability && !AbilitySpec->IsActive())
+			{
+				if (GetSpecActivationFlags(*AbilitySpec).ActivationMethod == EAbilityActivationMethod::WhileInput)
+				{
+					if (!TryActivatePendingAbility(SpecHandle) && !IsActivationParked(SpecHandle))
+					{
+						bUnparkedFailure = true;
+					}
+				}
+			}
+		}
+	}
+
+	EndServerActivationBatch();
+
+	// In event driven mode, failures that no event will notify are retried on the next tick as if polling.
+
+	if (bEventDrivenHeldInput && bUnparkedFailure)
+	{
+		RequestInputRetry();
+	}
+}
+
+void UGAEAbilitySystemComponent::CancelInputActivatedAbilities(bool bReplicateCancelAbility)
+{
+	TShouldCancelAbilityFunc ShouldCancelFunc = [this](const UGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
+	{
+		if (const auto* Flags{ FindSpecActivationFlags(Handle) })
+		{
+			return (Flags->ActivationMethod == EAbilityActivationMethod::OnInputTriggered);
+		}
+
+		return false;
+	};
+
+	CancelAbilitiesByFunc(ShouldCancelFunc, bReplicateCancelAbility);
+}
+
+void UGAEAbilitySystemComponent::MarkInputTagIndexDirty()
+{
+	bInputTagIndexDirty = true;
+}
+
+void UGAEAbilitySystemComponent::HandleAbilitySpecDirtied(const FGameplayAbilitySpec& Spec)
+{
+	// DynamicAbilityTags may have been changed
+
+	MarkInputTagIndexDirty();
+
+	UpdateSpecLevel(Spec);
+}
+
+void UGAEAbilitySystemComponent::UpdateSpecLevel(const FGameplayAbilitySpec& Spec)
+{
+	auto* Flags{ SpecActivationFlags.Find(Spec.Handle) };
+
+	if (!Flags || (Flags->Level == Spec.Level))
+	{
+		return;
+	}
+
+	Flags->Level = Spec.Level;
+
+	MarkActivationStateChanged();
+
+	// Notify the instance if there is one, same as when the ability is given
+
+	auto* PrimaryInstance{ Spec.GetPrimaryInstance() };
+
+	if (auto* GAEAbility{ Cast<UGAEGameplayAbility>(PrimaryInstance ? PrimaryInstance : Spec.Ability.Get()) })
+	{
+		GAEAbility->OnAbilityLevelChanged(AbilityActorInfo.Get(), Spec);
+	}
+}
+
+
+void UGAEAbilitySystemComponent::AddSpecToInputTagIndex(const FGameplayAbilitySpec& Spec)
+{
+	// No need to update incrementally, the whole index is rebuilt on next use.
+
+	if (bInputTagIndexDirty)
+	{
+		return;
+	}
+
+	const auto& Items{ ActivatableAbilities.Items };
+	const auto SpecIndex{ static_cast<int32>(&Spec - Items.GetData()) };
+
+	if (!Items.IsValidIndex(SpecIndex))
+	{
+		MarkInputTagIndexDirty();
+		return;
+	}
+
+	for (const auto& Tag : Spec.DynamicAbilityTags)
+	{
+		InputTagSpecIndex.FindOrAdd(Tag).Emplace(Spec.Handle, SpecIndex);
+	}
+}
+
+void UGAEAbilitySystemComponent::RebuildInputTagIndex()
+{
+	InputTagSpecIndex.Reset();
+
+	const auto& Items{ ActivatableAbilities.Items };
+
+	for (int32 SpecIndex{ 0 }; SpecIndex < Items.Num(); ++SpecIndex)
+	{
+		const auto& Spec{ Items[SpecIndex] };
+
+		for (const auto& Tag : Spec.DynamicAbilityTags)
+		{
+			InputTagSpecIndex.FindOrAdd(Tag).Emplace(Spec.Handle, SpecIndex);
+		}
+	}
+
+	bInputTagIndexDirty = false;
+}
+
+void UGAEAbilitySystemComponent::GetSpecHandlesForInputTag(const FGameplayTag& InputTag, TArray<FAbilitySpecIndexEntry, TInlineAllocator<8>>& OutEntries)
+{
+	if (bInputTagIndexDirty)
+	{
+		RebuildInputTagIndex();
+	}
+
+	if (const auto* Entries{ InputTagSpecIndex.Find(InputTag) })
+	{
+		OutEntries.Append(*Entries);
+	}
+}
+
+FGameplayAbilitySpec* UGAEAbilitySystemComponent::FindInputTagIndexedSpec(FAbilitySpecIndexEntry& Entry)
+{
+	const auto PrevSpecIndexHint{ Entry.SpecIndexHint };
+
+	auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) };
+
+	// The hint in the index is out of date, so refresh the index on next use.
+
+	if (Entry.SpecIndexHint != PrevSpecIndexHint)
+	{
+		MarkInputTagIndexDirty();
+	}
+
+	return AbilitySpec;
+}
+
+FGameplayAbilitySpec* UGAEAbilitySystemComponent::FindAbilitySpecFromHandleWithHint(const FGameplayAbilitySpecHandle& Handle, int32& InOutSpecIndexHint)
+{
+	auto& Items{ ActivatableAbilities.Items };
+
+	if (Items.IsValidIndex(InOutSpecIndexHint) && (Items[InOutSpecIndexHint].Handle == Handle))
+	{
+		return &Items[InOutSpecIndexHint];
+	}
+
+	for (int32 SpecIndex{ 0 }; SpecIndex < Items.Num(); ++SpecIndex)
+	{
+		if (Items[SpecIndex].Handle == Handle)
+		{
+			InOutSpecIndexHint = SpecIndex;
+			return &Items[SpecIndex];
+		}
+	}
+
+	InOutSpecIndexHint = INDEX_NONE;
+	return nullptr;
+}
+
+const FAbilitySpecActivationFlags& UGAEAbilitySystemComponent::GetSpecActivationFlags(const FGameplayAbilitySpec& Spec)
+{
+	if (const auto* Flags{ SpecActivationFlags.Find(Spec.Handle) })
+	{
+		return *Flags;
+	}
+
+	if (!Spec.Ability)
+	{
+		static const FAbilitySpecActivationFlags EmptyFlags;
+		return EmptyFlags;
+	}
+
+	// Specs whose ability had not been replicated yet when they were given are registered on first use.
+
+	return SpecActivationFlags.Add(Spec.Handle, FAbilitySpecActivationFlags(Spec.Ability));
+}
+
+const FAbilitySpecActivationFlags* UGAEAbilitySystemComponent::FindSpecActivationFlags(const FGameplayAbilitySpecHandle& Handle) const
+{
+	return SpecActivationFlags.Find(Handle);
+}
+
+
+void UGAEAbilitySystemComponent::BufferInput(const FAbilityBufferedInput& Input)
+{
+	RemoveBufferedInput(Input.Handle);
+
+	// Discard the oldest input if the buffer is full
+
+	if (InputBufferNum >= InputBufferSize)
+	{
+		InputBufferHead = (InputBufferHead + 1) % InputBufferSize;
+		--InputBufferNum;
+	}
+
+	const auto Index{ (InputBufferHead + InputBufferNum) % InputBufferSize };
+	InputBuffer[Index] = Input;
+
+	++InputBufferNum;
+}
+
+void UGAEAbilitySystemComponent::RemoveBufferedInput(const FGameplayAbilitySpecHandle& Handle)
+{
+	auto NewNum{ 0 };
+
+	for (auto Offset{ 0 }; Offset < InputBufferNum; ++Offset)
+	{
+		const auto& Input{ InputBuffer[(InputBufferHead + Offset) % InputBufferSize] };
+
+		if (Input.Handle != Handle)
+		{
+			InputBuffer[(InputBufferHead + NewNum) % InputBufferSize] = Input;
+			++NewNum;
+		}
+	}
+
+	InputBufferNum = NewNum;
+}
+
+void UGAEAbilitySystemComponent::ProcessBufferedInput()
+{
+	auto* World{ GetWorld() };
+
+	if ((InputBufferNum <= 0) || !World)
+	{
+		return;
+	}
+
+	const auto CurrentTime{ World->GetTimeSeconds() };
+
+	ABILITYLIST_SCOPE_LOCK();
+
+	BeginServerActivationBatch();
+
+	// Take out the buffered inputs, since activation may buffer new ones.
+
+	TArray<FAbilityBufferedInput, TInlineAllocator<InputBufferSize>> Inputs;
+
+	while (InputBufferNum > 0)
+	{
+		Inputs.Add(InputBuffer[InputBufferHead]);
+
+		InputBufferHead = (InputBufferHead + 1) % InputBufferSize;
+		--InputBufferNum;
+	}
+
+	InputBufferHead = 0;
+
+	for (const auto& Input : Inputs)
+	{
+		if (Input.ExpireTime < CurrentTime)
+		{
+			continue;
+		}
+
+		// Keep it without retrying if waiting for the condition blocking it to clear
+
+		if (IsActivationParked(Input.Handle))
+		{
+			BufferInput(Input);
+			continue;
+		}
+
+		// Discard if the ability has been removed or is no longer bound to the input
+
+		const auto* AbilitySpec{ FindAbilitySpecFromHandle(Input.Handle) };
+
+		if (!AbilitySpec || !AbilitySpec->Ability || !AbilitySpec->DynamicAbilityTags.HasTagExact(Input.InputTag))
+		{
+			continue;
+		}
+
+		// Keep it until it expires if still blocked. Wait for the ability to end if it is active.
+
+		if (AbilitySpec->IsActive() || !TryActivatePendingAbility(Input.Handle))
+		{
+			BufferInput(Input);
+		}
+	}
+
+	EndServerActivationBatch();
+}
+
+void UGAEAbilitySystemComponent::ClearInputBuffer()
+{
+	InputBufferHead = 0;
+	InputBufferNum = 0;
+}
+
+
+void UGAEAbilitySystemComponent::NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled)
+{
+	Super::NotifyAbilityEnded(Handle, Ability, bWasCancelled);
+
+	MarkActivationStateChanged();
+
+	const auto EntryIndex
+	{
+		ActiveSpecEntries.IndexOfByPredicate([&Handle](const FAbilitySpecIndexEntry& Entry) { return Entry.Handle == Handle; })
+	};
+
+	if (EntryIndex != INDEX_NONE)
+	{
+		auto& Entry{ ActiveSpecEntries[EntryIndex] };
+
+		const auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) };
+
+		if (!AbilitySpec || !AbilitySpec->IsActive())
+		{
+			ActiveSpecEntries.RemoveAtSwap(EntryIndex, 1, false);
+		}
+	}
+
+	// Ended ability may have been blocking others by its tags.
+
+	WakeParkedActivations(EAbilityActivateFailFlags::TagsBlocked | EAbilityActivateFailFlags::TagsMissing);
+
+	RequestInputRetry();
+}
+
+void UGAEAbilitySystemComponent::OnTagUpdated(const FGameplayTag& Tag, bool TagExists)
+{
+	Super::OnTagUpdated(Tag, TagExists);
+
+	MarkActivationStateChanged();
+
+	if (bUseTagBitSets)
+	{
+		UpdateOwnedTagBits(Tag);
+	}
+
+	// Removed tags may have been blocking, added tags may have been required.
+
+	WakeParkedActivations(EAbilityActivateFailFlags::TagsBlocked | EAbilityActivateFailFlags::TagsMissing);
+
+	RequestInputRetry();
+}
+
+void UGAEAbilitySystemComponent::RequestInputRetry()
+{
+	const auto bRetryHeldInput{ bEventDrivenHeldInput && !InputHeldSpecHandles.IsEmpty() };
+	const auto bRetryBufferedInput{ InputBufferNum > 0 };
+
+	if (bInputRetryPending || (!bRetryHeldInput && !bRetryBufferedInput))
+	{
+		return;
+	}
+
+	if (auto* World{ GetWorld() })
+	{
+		// Retry on next tick so that the state that triggered this request has settled.
+
+		bInputRetryPending = true;
+
+		World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::HandleInputRetry));
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleInputRetry()
+{
+	bInputRetryPending = false;
+
+	ProcessBufferedInput();
+
+	if (bEventDrivenHeldInput)
+	{
+		ProcessHeldInput();
+	}
+}
+
+bool UGAEAbilitySystemComponent::TryActivatePendingAbility(const FGameplayAbilitySpecHandle& Handle)
+{
+	LastFailedActivationHandle = FGameplayAbilitySpecHandle();
+	LastFailedActivationFlags = EAbilityActivateFailFlags::None;
+
+	if (TryActivateAbility(Handle))
+	{
+		ParkedActivations.Remove(Handle);
+		return true;
+	}
+
+	// Park only if the failure has been notified for this ability
+
+	if (LastFailedActivationHandle == Handle)
+	{
+		ParkActivation(Handle, LastFailedActivationFlags);
+	}
+	else
+	{
+		ParkedActivations.Remove(Handle);
+	}
+
+	return false;
+}
+
+void UGAEAbilitySystemComponent::ParkActivation(const FGameplayAbilitySpecHandle& Handle, EAbilityActivateFailFlags FailureFlags)
+{
+	// Only reasons that are notified by an event can be parked.
+	// Cooldowns are notified only for abilities using the cooldown of UGAEGameplayAbility.
+	// Costs are notified only if all the costs of the ability report their changes, and are parked only in event driven mode,
+	// since changes made outside of the costs (e.g, picking up ammo) rely on NotifyAbilityCostChanged() being called.
+
+	auto ParkableFlags{ EAbilityActivateFailFlags::TagsBlocked | EAbilityActivateFailFlags::TagsMissing };
+
+	if (const auto* Flags{ FindSpecActivationFlags(Handle) })
+	{
+		if (Flags->bIsGAEAbility && Flags->bUseCooldown)
+		{
+			ParkableFlags |= EAbilityActivateFailFlags::Cooldown;
+		}
+
+		if (bEventDrivenHeldInput && Flags->bCostChangeNotified)
+		{
+			ParkableFlags |= EAbilityActivateFailFlags::Cost;
+		}
+	}
+
+	if ((FailureFlags == EAbilityActivateFailFlags::None) || EnumHasAnyFlags(FailureFlags, ~ParkableFlags))
+	{
+		ParkedActivations.Remove(Handle);
+		return;
+	}
+
+	ParkedActivations.Add(Handle, FailureFlags);
+}
+
+bool UGAEAbilitySystemComponent::IsActivationParked(const FGameplayAbilitySpecHandle& Handle) const
+{
+	return ParkedActivations.Contains(Handle);
+}
+
+void UGAEAbilitySystemComponent::WakeParkedActivations(EAbilityActivateFailFlags WakeFlags)
+{
+	for (auto It{ ParkedActivations.CreateIterator() }; It; ++It)
+	{
+		if (EnumHasAnyFlags(It->Value, WakeFlags))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleCooldownEffectAdded(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle ActiveHandle)
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("UGAEAbilitySystemComponent::HandleCooldownEffectAdded()"), STAT_UGAEAbilitySystemComponent_HandleCooldownEffectAdded, STATGROUP_Ability);
+
+	const auto* Entries{ CooldownSpecEntries.Find(Spec.GetContext().GetAbility()) };
+
+	if (!Entries)
+	{
+		return;
+	}
+
+	// Copy since the handlers may grant or remove abilities.
+
+	auto EntriesCopy{ *Entries };
+
+	for (auto& Entry : EntriesCopy)
+	{
+		const auto* AbilitySpec{ FindAbilitySpecFromHandleWithHint(Entry.Handle, Entry.SpecIndexHint) };
+		auto* Ability{ AbilitySpec ? GetCooldownHandlerAbility(*AbilitySpec) : nullptr };
+
+		if (Ability && Ability->IsCDGameplayEffectForThis(Spec))
+		{
+			Ability->HandleCooldownEffectAdded(this, Entry.Handle, Spec, ActiveHandle);
+		}
+	}
+}
+
+UGAEGameplayAbility* UGAEAbilitySystemComponent::GetCooldownHandlerAbility(const FGameplayAbilitySpec& AbilitySpec) const
+{
+	// Instanced abilities handle the cooldown on their instance, NonInstanced ones on the CDO.
+
+	auto* PrimaryInstance{ AbilitySpec.GetPrimaryInstance() };
+
+	return Cast<UGAEGameplayAbility>(PrimaryInstance ? PrimaryInstance : AbilitySpec.Ability.Get());
+}
+
+
+void UGAEAbilitySystemComponent::HandleTimestampCooldownUpdated(const FAbilityCooldownTimestamp& Timestamp)
+{
+	// Copy since the cooldown hooks may use other charges.
+
+	const auto Handle{ Timestamp.Handle };
+	const auto ReadyTime{ Timestamp.GetReadyTime() };
+	const auto Now{ GetServerWorldTimeSeconds() };
+
+	const auto* CooldownState{ FindSpecCooldownState(Handle) };
+	const auto bCoolingdown{ CooldownState && CooldownState->bCoolingdown };
+
+	if ((ReadyTime > Now) && !bCoolingdown)
+	{
+		BeginSpecCooldown(Handle, ReadyTime - Timestamp.RechargeInterval, ReadyTime);
+	}
+	else if ((ReadyTime <= Now) && bCoolingdown)
+	{
+		EndSpecCooldown(Handle);
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleTimestampCooldownRemoved(const FGameplayAbilitySpecHandle& Handle)
+{
+	const auto* CooldownState{ FindSpecCooldownState(Handle) };
+
+	if (CooldownState && CooldownState->bCoolingdown)
+	{
+		EndSpecCooldown(Handle);
+	}
+}
+
+void UGAEAbilitySystemComponent::BeginSpecCooldown(const FGameplayAbilitySpecHandle& Handle, double StartTime, double EndTime)
+{
+	FindOrAddSpecCooldownState(Handle).Begin(StartTime, EndTime);
+
+	const auto Duration{ static_cast<float>(FMath::Max(EndTime - GetServerWorldTimeSeconds(), 0.0)) };
+
+	const auto* AbilitySpec{ FindAbilitySpecFromHandle(Handle) };
+
+	if (auto* Ability{ AbilitySpec ? GetCooldownHandlerAbility(*AbilitySpec) : nullptr })
+	{
+		Ability->DispatchCooldownStart(Handle, AbilityActorInfo.Get(), Duration);
+	}
+
+	NotifyAbilityCooldownStarted(Handle);
+}
+
+void UGAEAbilitySystemComponent::EndSpecCooldown(const FGameplayAbilitySpecHandle& Handle)
+{
+	if (auto* CooldownState{ FindSpecCooldownState(Handle) })
+	{
+		CooldownState->End();
+	}
+
+	const auto* AbilitySpec{ FindAbilitySpecFromHandle(Handle) };
+
+	if (auto* Ability{ AbilitySpec ? GetCooldownHandlerAbility(*AbilitySpec) : nullptr })
+	{
+		Ability->DispatchCooldownEnd(Handle, AbilityActorInfo.Get());
+	}
+
+	NotifyAbilityCooldownEnded(Handle);
+}
+
+void UGAEAbilitySystemComponent::ScheduleTimestampCooldownTimer()
+{
+	auto* World{ GetWorld() };
+
+	if (!World)
+	{
+		return;
+	}
+
+	// Only the server removes cooldowns, clients only need to know when a charge comes back.
+
+	const auto bAuthority{ IsOwnerActorAuthoritative() };
+
+	auto NextTime{ TNumericLimits<double>::Max() };
+
+	for (const auto& Timestamp : CooldownTimestamps.GetItems())
+	{
+		const auto* CooldownState{ FindSpecCooldownState(Timestamp.Handle) };
+
+		if (CooldownState && CooldownState->bCoolingdown)
+		{
+			NextTime = FMath::Min(NextTime, Timestamp.GetReadyTime());
+		}
+
+		if (bAuthority)
+		{
+			NextTime = FMath::Min(NextTime, Timestamp.EndTime);
+		}
+	}
+
+	// The previous timer is left in the wheel and ignored by its serial.
+
+	++CooldownTimerSerial;
+
+	if (NextTime == TNumericLimits<double>::Max())
+	{
+		return;
+	}
+
+	if (auto* TimerSubsystem{ World->GetSubsystem<UAbilityCooldownTimerSubsystem>() })
+	{
+		// The wheel runs on the local world time.
+
+		const auto Delay{ FMath::Max(NextTime - GetServerWorldTimeSeconds(), 0.0) };
+
+		TimerSubsystem->ScheduleTimer(this, World->GetTimeSeconds() + Delay, CooldownTimerSerial);
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleCooldownTimerExpired(uint32 Serial)
+{
+	if (Serial == CooldownTimerSerial)
+	{
+		HandleTimestampCooldownTimer();
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleTimestampCooldownTimer()
+{
+	if (IsOwnerActorAuthoritative())
+	{
+		TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>> ExpiredHandles;
+
+		CooldownTimestamps.RemoveExpired(GetServerWorldTimeSeconds(), ExpiredHandles);
+
+		if (!ExpiredHandles.IsEmpty())
+		{
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CooldownTimestamps, this);
+		}
+
+		for (const auto& Handle : ExpiredHandles)
+		{
+			HandleTimestampCooldownRemoved(Handle);
+		}
+	}
+
+	// Give back the charges that have been recharged.
+
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>> Handles;
+
+	for (const auto& Timestamp : CooldownTimestamps.GetItems())
+	{
+		Handles.Add(Timestamp.Handle);
+	}
+
+	for (const auto& Handle : Handles)
+	{
+		if (const auto* Timestamp{ CooldownTimestamps.Find(Handle) })
+		{
+			HandleTimestampCooldownUpdated(*Timestamp);
+		}
+	}
+
+	ScheduleTimestampCooldownTimer();
+}
+
+void UGAEAbilitySystemComponent::StartTimestampCooldown(const FGameplayAbilitySpecHandle& Handle, float RechargeInterval, int32 MaxCharges)
+{
+	if (!IsOwnerActorAuthoritative() || (RechargeInterval <= 0.0f))
+	{
+		return;
+	}
+
+	const auto& Timestamp
+	{
+		CooldownTimestamps.UseCharge(Handle, GetServerWorldTimeSeconds(), RechargeInterval, static_cast<uint8>(FMath::Clamp(MaxCharges, 1, 255)))
+	};
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CooldownTimestamps, this);
+
+	HandleTimestampCooldownUpdated(Timestamp);
+
+	ScheduleTimestampCooldownTimer();
+}
+
+void UGAEAbilitySystemComponent::ClearTimestampCooldown(const FGameplayAbilitySpecHandle& Handle)
+{
+	if (IsOwnerActorAuthoritative() && CooldownTimestamps.Remove(Handle))
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CooldownTimestamps, this);
+
+		HandleTimestampCooldownRemoved(Handle);
+
+		ScheduleTimestampCooldownTimer();
+	}
+}
+
+float UGAEAbilitySystemComponent::GetAbilityCooldownTimeRemaining(FGameplayAbilitySpecHandle Handle) const
+{
+	const auto* CooldownState{ FindSpecCooldownState(Handle) };
+
+	return CooldownState ? CooldownState->GetRemainingTime(GetServerWorldTimeSeconds()) : 0.0f;
+}
+
+float UGAEAbilitySystemComponent::GetAbilityCooldownProgress(FGameplayAbilitySpecHandle Handle) const
+{
+	const auto* CooldownState{ FindSpecCooldownState(Handle) };
+
+	return CooldownState ? CooldownState->GetProgress(GetServerWorldTimeSeconds()) : 1.0f;
+}
+
+double UGAEAbilitySystemComponent::GetServerWorldTimeSeconds() const
+{
+	const auto* World{ GetWorld() };
+	const auto* GameState{ World ? World->GetGameState() : nullptr };
+
+	return GameState ? GameState->GetServerWorldTimeSeconds() : (World ? World->GetTimeSeconds() : 0.0);
+}
+
+void UGAEAbilitySystemComponent::NotifyAbilityCooldownStarted(const FGameplayAbilitySpecHandle& Handle)
+{
+	MarkActivationStateChanged();
+}
+
+void UGAEAbilitySystemComponent::NotifyAbilityCooldownEnded(const FGameplayAbilitySpecHandle& Handle)
+{
+	MarkActivationStateChanged();
+
+	// Non-instanced abilities do not know the spec, so wake all the ones waiting for cooldown.
+
+	if (!Handle.IsValid())
+	{
+		WakeParkedActivations(EAbilityActivateFailFlags::Cooldown);
+	}
+	else if (const auto* FailureFlags{ ParkedActivations.Find(Handle) })
+	{
+		if (EnumHasAnyFlags(*FailureFlags, EAbilityActivateFailFlags::Cooldown))
+		{
+			ParkedActivations.Remove(Handle);
+		}
+	}
+
+	RequestInputRetry();
+}
+
+void UGAEAbilitySystemComponent::NotifyAbilityCostChanged()
+{
+	MarkActivationStateChanged();
+
+	WakeParkedActivations(EAbilityActivateFailFlags::Cost);
+
+	RequestInputRetry();
+}
+
+void UGAEAbilitySystemComponent::ObserveCostAttributes(const UGameplayAbility* Ability)
+{
+	const auto* CostEffect{ Ability ? Ability->GetCostGameplayEffect() : nullptr };
+
+	if (!CostEffect)
+	{
+		return;
+	}
+
+	for (const auto& Modifier : CostEffect->Modifiers)
+	{
+		if (Modifier.Attribute.IsValid() && !ObservedCostAttributes.Contains(Modifier.Attribute))
+		{
+			ObservedCostAttributes.Add(Modifier.Attribute);
+
+			GetGameplayAttributeValueChangeDelegate(Modifier.Attribute).AddUObject(this, &ThisClass::HandleCostAttributeChanged);
+		}
+	}
+}
+
+void UGAEAbilitySystemComponent::HandleCostAttributeChanged(const FOnAttributeChangeData& ChangeData)
+{
+	NotifyAbilityCostChanged();
+}
+
+
+void UGAEAbilitySystemComponent::CallServerTryActivateAbility(FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey)
+{
+	// Locally predicted abilities are activated right after this and may send other RPCs during the activation.
+	// The held requests are sent before them, but a cancellation is only caught for GAE abilities.
+
+	const auto* Flags{ FindSpecActivationFlags(AbilityToActivate) };
+	const auto bCanHold{ Flags && (!Flags->bLocalPredicted || Flags->bIsGAEAbility) };
+
+	if ((ServerActivationBatchDepth > 0) && bCanHold)
+	{
+		// Send the held ones first if the same ability is requested again or the batch is full
+
+		const auto bAlreadyHeld
+		{
+			PendingServerActivationRequests.ContainsByPredicate([&AbilityToActivate](const FAbilityBatchedActivationRequest& Request) { return Request.Handle == AbilityToActivate; })
+		};
+
+		if (bAlreadyHeld || (PendingServerActivationRequests.Num() >= MaxServerActivationBatchSize))
+		{
+			FlushServerActivationRequests();
+		}
+
+		PendingServerActivationRequests.Emplace(AbilityToActivate, InputPressed, PredictionKey);
+		return;
+	}
+
+	// Keep the order of the requests
+
+	FlushServerActivationRequests();
+
+	Super::CallServerTryActivateAbility(AbilityToActivate, InputPressed, PredictionKey);
+}
+
+void UGAEAbilitySystemComponent::CallServerSetReplicatedTargetData(FGameplayAbilitySpecHandle AbilityHandle, FPredictionKey AbilityOriginalPredictionKey, const FGameplayAbilityTargetDataHandle& ReplicatedTargetDataHandle, FGameplayTag ApplicationTag, FPredictionKey CurrentPredictionKey)
+{
+	// The server must receive the held activations before any other RPC.
+
+	FlushServerActivationRequests();
+
+	Super::CallServerSetReplicatedTargetData(AbilityHandle, AbilityOriginalPredictionKey, ReplicatedTargetDataHandle, ApplicationTag, CurrentPredictionKey);
+}
+
+void UGAEAbilitySystemComponent::CallServerEndAbility(FGameplayAbilitySpecHandle AbilityToEnd, FGameplayAbilityActivationInfo ActivationInfo, FPredictionKey PredictionKey)
+{
+	// The server must receive the held activations before any other RPC.
+
+	FlushServerActivationRequests();
+
+	Super::CallServerEndAbility(AbilityToEnd, ActivationInfo, PredictionKey);
+}
+
+void UGAEAbilitySystemComponent::FlushServerActivationRequests()
+{
+	if (PendingServerActivationRequests.IsEmpty())
+	{
+		return;
+	}
+
+	// Send as usual if there is nothing to batch
+
+	if (PendingServerActivationRequests.Num() == 1)
+	{
+		const auto Request{ PendingServerActivationRequests[0] };
+		PendingServerActivationRequests.Reset();
+
+		Super::CallServerTryActivateAbility(Request.Handle, Request.bInputPressed, Request.PredictionKey);
+		return;
+	}
+
+	const TArray<FAbilityBatchedActivationRequest> Requests{ PendingServerActivationRequests };
+	PendingServerActivationRequests.Reset();
+
+	ServerTryActivateAbilities(Requests);
+}
+
+void UGAEAbilitySystemComponent::ServerTryActivateAbilities_Implementation(const TArray<FAbilityBatchedActivationRequest>& Requests)
+{
+	ABILITYLIST_SCOPE_LOCK();
+
+	for (const auto& Request : Requests)
+	{
+		InternalServerTryActivateAbility(Request.Handle, Request.bInputPressed, Request.PredictionKey, nullptr);
+	}
+}
+
+bool UGAEAbilitySystemComponent::ServerTryActivateAbilities_Validate(const TArray<FAbilityBatchedActivationRequest>& Requests)
+{
+	// Clients never send batches larger than the limit or requesting the same ability twice
+
+	if (Requests.Num() > MaxServerActivationBatchSize)
+	{
+		return false;
+	}
+
+	for (auto Index{ 1 }; Index < Requests.Num(); ++Index)
+	{
+		for (auto OtherIndex{ 0 }; OtherIndex < Index; ++OtherIndex)
+		{
+			if (Requests[Index].Handle == Requests[OtherIndex].Handle)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void UGAEAbilitySystemComponent::BeginServerActivationBatch()
+{
+	++ServerActivationBatchDepth;
+}
+
+void UGAEAbilitySystemComponent::EndServerActivationBatch()
+{
+	if (ensure(ServerActivationBatchDepth > 0))
+	{
+		--ServerActivationBatchDepth;
+	}
+
+	if (ServerActivationBatchDepth == 0)
+	{
+		FlushServerActivationRequests();
+	}
+}
+
+
+FScopedOnSpawnActivationDeferral::FScopedOnSpawnActivationDeferral(UAbilitySystemComponent* InASC)
+	: ASC(Cast<UGAEAbilitySystemComponent>(InASC))
+{
+	if (auto* GAEASC{ ASC.Get() })
+	{
+		GAEASC->BeginDeferOnSpawnActivation();
+	}
+}
+
+FScopedOnSpawnActivationDeferral::~FScopedOnSpawnActivationDeferral()
+{
+	if (auto* GAEASC{ ASC.Get() })
+	{
+		GAEASC->EndDeferOnSpawnActivation();
+	}
 }
@@ -4,14 +4,345 @@
 
 #include "AbilitySystemComponent.h"
 #include "Components/GameFrameworkInitStateInterface.h"
+#include "Containers/StaticArray.h"
+#include "Misc/ScopeRWLock.h"
 
 #include "GAEGameplayAbility.h"
+#include "Type/AbilityActivateFailTypes.h"
+#include "Type/AbilityCooldownTimestampTypes.h"
+#include "Type/AbilityCostStatTagTargetTypes.h"
+#include "Type/AbilityTagBitSet.h"
 
 #include "GAEAbilitySystemComponent.generated.h"
 
 class UAbilityTagRelationshipMapping;
 
 
+/**
+ * Ability spec handle with a hint to the position of the spec in ActivatableAbilities.Items
+ */
+struct FAbilitySpecIndexEntry
+{
+public:
+	FAbilitySpecIndexEntry() {}
+
+	FAbilitySpecIndexEntry(const FGameplayAbilitySpecHandle& InHandle, int32 InSpecIndexHint)
+		: Handle(InHandle), SpecIndexHint(InSpecIndexHint)
+	{}
+
+public:
+	FGameplayAbilitySpecHandle Handle;
+
+	//
+	// Last known index of the spec in ActivatableAbilities.Items
+	//
+	int32 SpecIndexHint{ INDEX_NONE };
+
+};
+
+
+/**
+ * Input event recorded while input events are queued
+ */
+struct FAbilityQueuedInputEvent
+{
+public:
+	FAbilityQueuedInputEvent() {}
+
+	FAbilityQueuedInputEvent(const FGameplayTag& InInputTag, bool bInPressed)
+		: InputTag(InInputTag), bPressed(bInPressed)
+	{}
+
+public:
+	FGameplayTag InputTag;
+
+	bool bPressed{ false };
+
+};
+
+
+/**
+ * Input press that failed to activate an ability and is waiting to be replayed
+ */
+struct FAbilityBufferedInput
+{
+public:
+	FAbilityBufferedInput() {}
+
+	FAbilityBufferedInput(const FGameplayAbilitySpecHandle& InHandle, const FGameplayTag& InInputTag, double InExpireTime)
+		: Handle(InHandle), InputTag(InInputTag), ExpireTime(InExpireTime)
+	{}
+
+public:
+	FGameplayAbilitySpecHandle Handle;
+
+	FGameplayTag InputTag;
+
+	//
+	// World time in seconds after which the input is discarded
+	//
+	double ExpireTime{ 0.0 };
+
+};
+
+
+/**
+ * Record of the last activation failure notified for an ability spec
+ */
+struct FAbilityFailureNotifyRecord
+{
+public:
+	FAbilityFailureNotifyRecord() {}
+
+public:
+	double LastNotifyTime{ 0.0 };
+
+	uint32 FailureReasonHash{ 0 };
+
+};
+
+
+/**
+ * Packed activation settings of a granted ability spec, cached so that hot paths do not need to read the ability CDO
+ */
+struct FAbilitySpecActivationFlags
+{
+public:
+	FAbilitySpecActivationFlags()
+		: bIsGAEAbility(false), bUseCooldown(false), bHasCostEffect(false), bLocalPredicted(false), bCostChangeNotified(true), bCacheableActivationResult(true)
+	{}
+
+	explicit FAbilitySpecActivationFlags(const UGameplayAbility* Ability);
+
+public:
+	EAbilityActivationMethod ActivationMethod{ EAbilityActivationMethod::Custom };
+
+	EAbilityActivationPolicy ActivationPolicy{ EAbilityActivationPolicy::Default };
+
+	float InputBufferWindow{ 0.0f };
+
+	//
+	// Level of the spec last notified to the ability
+	//
+	int32 Level{ 0 };
+
+	uint8 bIsGAEAbility : 1;
+
+	uint8 bUseCooldown : 1;
+
+	uint8 bHasCostEffect : 1;
+
+	uint8 bLocalPredicted : 1;
+
+	//
+	// Whether every change of the values read by the cost check is notified (see UAbilityCost::IsCostChangeNotified())
+	//
+	uint8 bCostChangeNotified : 1;
+
+	//
+	// Whether all state read by the activation check is tracked by the activation state generation
+	//
+	uint8 bCacheableActivationResult : 1;
+
+};
+
+
+/**
+ * Activation required and blocked tags of an ability merged with the ones from the tag relationship mapping
+ */
+struct FAbilityActivationTagRequirements
+{
+public:
+	FAbilityActivationTagRequirements() {}
+
+public:
+	FGameplayTagContainer RequiredTags;
+
+	FGameplayTagContainer BlockedTags;
+
+	//
+	// Ability tags with their parent tags
+	//
+	FAbilityTagBitSet AbilityTagBits;
+
+	FAbilityTagBitSet RequiredTagBits;
+
+	FAbilityTagBitSet BlockedTagBits;
+
+	//
+	// Whether all the tags could be represented by the bit sets
+	//
+	bool bTagBitsValid{ false };
+
+};
+
+
+/**
+ * Cooldown state of an ability spec
+ * 
+ * Tips:
+ *	Held by the AbilitySystemComponent instead of the ability instance so that abilities can be NonInstanced.
+ */
+struct FAbilitySpecCooldownState
+{
+public:
+	FAbilitySpecCooldownState() {}
+
+public:
+	//
+	// Active GameplayEffect handle of the current cooldown
+	//
+	FActiveGameplayEffectHandle CooldownGEHandle;
+
+	//
+	// Whether the cooldown is in progress
+	//
+	bool bCoolingdown{ false };
+
+	//
+	// Server world time when the current or last cooldown started
+	//
+	double StartTime{ 0.0 };
+
+	//
+	// Server world time when the current or last cooldown ends
+	//
+	double EndTime{ 0.0 };
+
+public:
+	/**
+	 * Begins or ends the cooldown and records the time of it
+	 */
+	void Begin(double InStartTime, double InEndTime)
+	{
+		bCoolingdown = true;
+		StartTime = InStartTime;
+		EndTime = InEndTime;
+	}
+
+	void End()
+	{
+		bCoolingdown = false;
+	}
+
+	/**
+	 * Returns the remaining time of the cooldown at the server world time
+	 */
+	float GetRemainingTime(double Time) const
+	{
+		return bCoolingdown ? static_cast<float>(FMath::Max(EndTime - Time, 0.0)) : 0.0f;
+	}
+
+	/**
+	 * Returns how much of the cooldown has elapsed at the server world time, from 0 to 1
+	 */
+	float GetProgress(double Time) const
+	{
+		const auto Duration{ EndTime - StartTime };
+
+		return (bCoolingdown && (Duration > 0.0)) ? static_cast<float>(FMath::Clamp((Time - StartTime) / Duration, 0.0, 1.0)) : 1.0f;
+	}
+
+};
+
+
+/**
+ * Ability activation request sent to the server together with others in a single RPC
+ */
+USTRUCT()
+struct FAbilityBatchedActivationRequest
+{
+	GENERATED_BODY()
+public:
+	FAbilityBatchedActivationRequest() {}
+
+	FAbilityBatchedActivationRequest(const FGameplayAbilitySpecHandle& InHandle, bool bInInputPressed, const FPredictionKey& InPredictionKey)
+		: Handle(InHandle), bInputPressed(bInInputPressed), PredictionKey(InPredictionKey)
+	{}
+
+public:
+	UPROPERTY()
+	FGameplayAbilitySpecHandle Handle;
+
+	UPROPERTY()
+	bool bInputPressed{ false };
+
+	UPROPERTY()
+	FPredictionKey PredictionKey;
+
+};
+
+
+/**
+ * Result of the activation check of an ability spec by UGAEAbilitySystemComponent::QueryActivatableAbilities()
+ */
+USTRUCT(BlueprintType)
+struct FAbilityActivationQueryResult
+{
+	GENERATED_BODY()
+public:
+	FAbilityActivationQueryResult() {}
+
+public:
+	UPROPERTY(BlueprintReadOnly)
+	FGameplayAbilitySpecHandle Handle;
+
+	UPROPERTY(BlueprintReadOnly)
+	TWeakObjectPtr<UGAEGameplayAbility> Ability{ nullptr };
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bCanActivate{ false };
+
+	//
+	// Reasons why the ability can not be activated (EAbilityActivateFailFlags)
+	//
+	UPROPERTY(BlueprintReadOnly, meta = (Bitmask, BitmaskEnum = "/Script/GAExt.EAbilityActivateFailFlags"))
+	uint8 FailureFlags{ 0 };
+
+public:
+	EAbilityActivateFailFlags GetFailureFlags() const { return static_cast<EAbilityActivateFailFlags>(FailureFlags); }
+	void SetFailureFlags(EAbilityActivateFailFlags InFailureFlags) { FailureFlags = static_cast<uint8>(InFailureFlags); }
+
+};
+
+
+/**
+ * State shared by all the activation checks of a UGAEAbilitySystemComponent::QueryActivatableAbilities() pass.
+ * While alive, it is the current query of the thread for the AbilitySystemComponent.
+ */
+struct GAEXT_API FAbilityActivationQueryContext
+{
+public:
+	explicit FAbilityActivationQueryContext(const UAbilitySystemComponent* InASC);
+	~FAbilityActivationQueryContext();
+
+	FAbilityActivationQueryContext(const FAbilityActivationQueryContext&) = delete;
+	FAbilityActivationQueryContext& operator=(const FAbilityActivationQueryContext&) = delete;
+
+public:
+	const UAbilitySystemComponent* ASC{ nullptr };
+
+	bool bIgnoreCooldowns{ false };
+
+	bool bIgnoreCosts{ false };
+
+	//
+	// Stack counts of stat tags on the cost targets read in this query
+	//
+	TMap<TPair<TObjectKey<UObject>, FGameplayTag>, int32> StatTagStackCounts;
+
+private:
+	FAbilityActivationQueryContext* OuterContext{ nullptr };
+
+public:
+	/**
+	 * Returns the query in progress on this thread for the AbilitySystemComponent, or nullptr if there is none
+	 */
+	static FAbilityActivationQueryContext* Get(const UAbilitySystemComponent* InASC);
+
+};
+
+
 /**
  * AbilitySystemComponent with additional functionality to extend the ability management 
  * and to enable implementation of processing by player input.
@@ -24,6 +355,9 @@ UCLASS(meta = (BlueprintSpawnableComponent))
 class GAEXT_API UGAEAbilitySystemComponent : public UAbilitySystemComponent, public IGameFrameworkInitStateInterface
 {
 	GENERATED_BODY()
+
+	friend struct FAbilityCooldownTimestamp;
+	friend class UAbilityCooldownTimerSubsystem;
 public:
 	UGAEAbilitySystemComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
@@ -55,20 +389,182 @@ public:
 	virtual void CheckDefaultInitialization() override;
 
 
+protected:
+	//
+	// Time window in seconds in which repeated identical activation failures of the same "WhileInput" ability are sent to the client only once
+	// 
+	// Tips:
+	//	Avoids sending a notification RPC every time the held input is retried while, for example, the ability is blocked by cooldown.
+	//	Failures notified locally and failures of other activation methods (e.g, discrete presses) are never throttled.
+	//	If 0 or less, all failures are sent.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Activation Failure", meta = (ClampMin = 0.00, Units = "s"))
+	float AbilityFailedNotifyInterval{ 0.5f };
+
+	//
+	// Last activation failure notified for each ability spec
+	//
+	TMap<FGameplayAbilitySpecHandle, FAbilityFailureNotifyRecord> AbilityFailureNotifyRecords;
+
 protected:
 	virtual void NotifyAbilityFailed(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason) override;
 
-	void TryActivateAbilitiesOnSpawn();
+	/**
+	 * Returns whether the failure should be sent to the client, or whether it is a repeat of a held input retry sent within AbilityFailedNotifyInterval
+	 */
+	bool ShouldNotifyAbilityFailed(const FGameplayAbilitySpecHandle& Handle, const FGameplayTagContainer& FailureReason, bool bCompact, EAbilityActivateFailFlags FailureFlags);
 
 	/** Notify client that an ability failed to activate */
 	UFUNCTION(Client, Unreliable)
 	void ClientNotifyAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
 	void ClientNotifyAbilityFailed_Implementation(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
 
-	void HandleAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
+	/** Notify client that an ability failed to activate, with the reason packed as flags */
+	UFUNCTION(Client, Unreliable)
+	void ClientNotifyAbilityFailedCompact(const UGameplayAbility* Ability, EAbilityActivateFailFlags FailureFlags);
+	void ClientNotifyAbilityFailedCompact_Implementation(const UGameplayAbility* Ability, EAbilityActivateFailFlags FailureFlags);
+
+	void HandleAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
+
+
+protected:
+	//
+	// Handles to abilities that are currently active
+	// 
+	// Note:
+	//	This may temporarily contain handles of abilities that have already ended, they are pruned when walked.
+	//
+	TArray<FAbilitySpecIndexEntry, TInlineAllocator<4>> ActiveSpecEntries;
+
+protected:
+	virtual void NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability) override;
+
+	/**
+	 * Removes the entries of abilities that are no longer active and updates the index hints
+	 */
+	void PruneActiveSpecEntries();
+
+public:
+	typedef TFunctionRef<bool(const UGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)> TShouldCancelAbilityFunc;
+
+	/**
+	 * Cancel the active abilities for which ShouldCancelFunc returns true.
+	 * 
+	 * Tips:
+	 *	Only currently active abilities are visited, so the cost does not depend on the number of granted abilities.
+	 */
+	void CancelAbilitiesByFunc(TShouldCancelAbilityFunc ShouldCancelFunc, bool bReplicateCancelAbility);
+
+	/**
+	 * Gathers the handles of the currently active abilities
+	 */
+	void GetActiveAbilitySpecHandles(TArray<FGameplayAbilitySpecHandle>& OutHandles);
+
+
+public:
+	/**
+	 * Checks whether each granted GAEGameplayAbility can be activated now in a single pass
+	 * 
+	 * Tips:
+	 *	Cheaper than calling CanActivateAbility() for each ability, 
+	 *	since the ignore flags and the stat tag stack counts of the cost targets are read only once in the pass.
+	 *	If OutActivatableMask is specified, it gets a bit per entry of OutResults that is set if the ability can be activated.
+	 */
+	void QueryActivatableAbilities(TArray<FAbilityActivationQueryResult>& OutResults, TBitArray<>* OutActivatableMask = nullptr);
+
+	UFUNCTION(BlueprintCallable, Category = "Ability Activation", meta = (DisplayName = "Query Activatable Abilities"))
+	void BP_QueryActivatableAbilities(TArray<FAbilityActivationQueryResult>& OutResults);
+
+	/**
+	 * Checks whether the ability spec can be activated now
+	 * 
+	 * Tips:
+	 *	Same as QueryActivatableAbilities() but for a single ability spec.
+	 */
+	bool QueryCanActivateAbility(const FGameplayAbilitySpecHandle& Handle, EAbilityActivateFailFlags* OutFailureFlags = nullptr);
+
+protected:
+	//
+	// Whether to reuse the results of QueryActivatableAbilities() and QueryCanActivateAbility()
+	// until something that could change them happens
+	// 
+	// Note:
+	//	Tracked changes are owned tags, blocked ability tags, cooldown start and end, attributes modified by cost GameplayEffects,
+	//	cost changes notified by NotifyAbilityCostChanged(), abilities being granted, removed, activated or ended, and actor info changes.
+	//	Abilities with additional costs whose changes are not notified (see UAbilityCost::IsCostChangeNotified()) are never cached.
+	//	State read only by a blueprint CanActivateAbility is not tracked, call MarkActivationStateChanged() when it changes.
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ability Activation")
+	bool bCacheActivationQueryResults{ false };
+
+	//
+	// Incremented whenever something that could change the results of activation checks happens
+	//
+	uint32 ActivationStateGeneration{ 1 };
+
+	//
+	// Results of activation queries and the generation they were checked in
+	//
+	TMap<FGameplayAbilitySpecHandle, TPair<uint32, FAbilityActivationQueryResult>> ActivationQueryResultCache;
+
+protected:
+	/**
+	 * Checks whether the ability spec can be activated, or reuses the cached result if it is still valid
+	 */
+	void EvaluateActivationQuery(const FGameplayAbilitySpec& AbilitySpec, FGameplayTagContainer& FailureTags, FAbilityActivationQueryResult& OutResult);
+	const FAbilityActivationQueryResult* FindCachedActivationQueryResult(const FGameplayAbilitySpecHandle& Handle) const;
+
+	virtual void SetUserAbilityActivationInhibited(bool NewInhibit) override;
+
+public:
+	/**
+	 * Invalidates the cached results of activation queries
+	 */
+	void MarkActivationStateChanged() { ++ActivationStateGeneration; }
+
+	uint32 GetActivationStateGeneration() const { return ActivationStateGeneration; }
+
+
+protected:
+	//
+	// Handles to abilities whose activation method is "OnSpawn"
+	//
+	TArray<FAbilitySpecIndexEntry, TInlineAllocator<4>> OnSpawnSpecEntries;
+
+	//
+	// Handles to "OnSpawn" abilities that have been granted but have not tried to activate yet
+	//
+	TArray<FAbilitySpecIndexEntry, TInlineAllocator<4>> PendingOnSpawnSpecEntries;
+
+	//
+	// Number of FScopedOnSpawnActivationDeferral currently alive for this component
+	//
+	int32 OnSpawnActivationDeferralCount{ 0 };
+
+protected:
+	/**
+	 * Try activate all "OnSpawn" activation method abilities
+	 */
+	void TryActivateAbilitiesOnSpawn();
+	void TryActivateSpecOnSpawn(const FGameplayAbilitySpec& Spec);
+
+public:
+	/**
+	 * Try activate "OnSpawn" activation method abilities that have been granted since the last call
+	 *
+	 * Tips:
+	 *	This is called automatically when abilities are granted outside of a FScopedOnSpawnActivationDeferral.
+	 */
+	void TryActivatePendingAbilitiesOnSpawn();
 
-	typedef TFunctionRef<bool(const UGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)> TShouldCancelAbilityFunc;
-	void CancelAbilitiesByFunc(TShouldCancelAbilityFunc ShouldCancelFunc, bool bReplicateCancelAbility);
+	/**
+	 * Defer activation of "OnSpawn" abilities granted until the matching EndDeferOnSpawnActivation() call.
+	 * 
+	 * Tips:
+	 *	Prefer using FScopedOnSpawnActivationDeferral.
+	 */
+	void BeginDeferOnSpawnActivation();
+	void EndDeferOnSpawnActivation();
 
 
 protected:
@@ -82,6 +578,20 @@ protected:
 	UPROPERTY(Replicated, Transient)
 	TObjectPtr<const UAbilityTagRelationshipMapping> TagRelationshipMapping;
 
+	//
+	// Activation requirements of each ability class merged with the ones from each TagRelationshipMapping
+	// 
+	// Note:
+	//	Allocated individually so that references to them stay valid while other threads add to the cache.
+	//	Entries of previous mappings are never freed while this component is alive, since other threads may still be reading them.
+	//
+	mutable TMap<TPair<TObjectKey<UAbilityTagRelationshipMapping>, TObjectKey<UClass>>, TUniquePtr<FAbilityActivationTagRequirements>> ActivationTagRequirementsCache;
+
+	//
+	// Guards ActivationTagRequirementsCache since activation may be checked from multiple threads
+	//
+	mutable FRWLock ActivationTagRequirementsCacheLock;
+
 protected:
 	virtual void ApplyAbilityBlockAndCancelTags(const FGameplayTagContainer& AbilityTags, UGameplayAbility* RequestingAbility, bool bEnableBlockTags, const FGameplayTagContainer& BlockTags, bool bExecuteCancelTags, const FGameplayTagContainer& CancelTags) override;
 
@@ -97,6 +607,58 @@ public:
 	 */
 	void GetAdditionalActivationTagRequirements(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer& OutActivationRequired, FGameplayTagContainer& OutActivationBlocked) const;
 
+	/**
+	 * Returns the activation required and blocked tags of the ability including the additional ones from the mapping
+	 * 
+	 * Tips:
+	 *	The result is cached per mapping and ability class, and stays valid while this component is alive.
+	 *	Safe to call from any thread.
+	 */
+	const FAbilityActivationTagRequirements& GetActivationTagRequirements(const UGAEGameplayAbility& Ability) const;
+
+
+protected:
+	//
+	// Whether to keep the owned tags and blocked ability tags as bit sets and use them to check activation tag requirements
+	// 
+	// Tips:
+	//	Checks become a few word-wide operations regardless of the number of owned tags, 
+	//	at the cost of updating the bit sets when tags are added or removed.
+	//
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Tag Relationship")
+	bool bUseTagBitSets{ false };
+
+	//
+	// Owned tags with their parent tags
+	//
+	FAbilityTagBitSet OwnedTagBits;
+
+	//
+	// Ability tags currently blocked
+	//
+	FAbilityTagBitSet BlockedAbilityTagBits;
+
+	//
+	// Whether all the blocked ability tags could be represented by BlockedAbilityTagBits
+	//
+	bool bBlockedAbilityTagBitsValid{ true };
+
+protected:
+	virtual void BlockAbilitiesWithTags(const FGameplayTagContainer& Tags) override;
+	virtual void UnBlockAbilitiesWithTags(const FGameplayTagContainer& Tags) override;
+
+	void UpdateOwnedTagBits(const FGameplayTag& Tag);
+	void RebuildBlockedAbilityTagBits();
+
+public:
+	/**
+	 * Returns whether the activation tag requirements can be checked with the bit sets
+	 */
+	bool CanUseTagBitSets() const { return bUseTagBitSets && bBlockedAbilityTagBitsValid; }
+
+	const FAbilityTagBitSet& GetOwnedTagBits() const { return OwnedTagBits; }
+	const FAbilityTagBitSet& GetBlockedAbilityTagBits() const { return BlockedAbilityTagBits; }
+
 
 protected:
 	//
@@ -104,7 +666,26 @@ protected:
 	//
 	TArray<FGameplayAbilitySpecHandle> InputHeldSpecHandles;
 
+	//
+	// Index from input tag (tags in DynamicAbilityTags) to the ability specs bound to it.
+	//
+	TMap<FGameplayTag, TArray<FAbilitySpecIndexEntry, TInlineAllocator<2>>> InputTagSpecIndex;
+
+	//
+	// Whether the input tag index needs to be rebuilt before it is used next time
+	//
+	bool bInputTagIndexDirty{ true };
+
+	//
+	// Activation settings of each granted ability spec
+	//
+	TMap<FGameplayAbilitySpecHandle, FAbilitySpecActivationFlags> SpecActivationFlags;
+
 protected:
+	virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRep_ActivateAbilities() override;
+
 	virtual void AbilitySpecInputPressed(FGameplayAbilitySpec& Spec) override;
 	virtual void AbilitySpecInputReleased(FGameplayAbilitySpec& Spec) override;
 
@@ -129,6 +710,385 @@ public:
 	 */
 	void CancelInputActivatedAbilities(bool bReplicateCancelAbility);
 
+	/**
+	 * Mark the input tag index as needing to be rebuilt.
+	 *
+	 * Note:
+	 *	Called automatically when an ability spec is marked dirty (MarkAbilitySpecDirty) and when the specs are replicated.
+	 */
+	void MarkInputTagIndexDirty();
+
+protected:
+	/**
+	 * Called when an already granted ability spec is modified (e.g, DynamicAbilityTags, Level)
+	 */
+	void HandleAbilitySpecDirtied(const FGameplayAbilitySpec& Spec);
+
+	/**
+	 * Notifies the ability if the level of the spec has changed since it was last notified
+	 */
+	void UpdateSpecLevel(const FGameplayAbilitySpec& Spec);
+
+	void AddSpecToInputTagIndex(const FGameplayAbilitySpec& Spec);
+	void RebuildInputTagIndex();
+
+	/**
+	 * Gathers the ability spec handles bound to the input tag
+	 */
+	void GetSpecHandlesForInputTag(const FGameplayTag& InputTag, TArray<FAbilitySpecIndexEntry, TInlineAllocator<8>>& OutEntries);
+
+	/**
+	 * Finds the ability spec using the index hint and falls back to a full search if the hint is out of date.
+	 * The hint is updated to the current position of the spec.
+	 */
+	FGameplayAbilitySpec* FindAbilitySpecFromHandleWithHint(const FGameplayAbilitySpecHandle& Handle, int32& InOutSpecIndexHint);
+	FGameplayAbilitySpec* FindInputTagIndexedSpec(FAbilitySpecIndexEntry& Entry);
+
+	/**
+	 * Returns the cached activation settings of the ability spec
+	 */
+	const FAbilitySpecActivationFlags& GetSpecActivationFlags(const FGameplayAbilitySpec& Spec);
+	const FAbilitySpecActivationFlags* FindSpecActivationFlags(const FGameplayAbilitySpecHandle& Handle) const;
+
+
+protected:
+	//
+	// Whether to record input presses and releases and process them once per frame instead of immediately.
+	// 
+	// Tips:
+	//	Input events are processed in the order they were received, and each ability is activated at most once per frame.
+	//	Call ProcessQueuedInputEvents() after the player input has been processed (e.g, PlayerController::PostProcessInput) 
+	//	to avoid a frame of latency, otherwise they are processed on the next tick of this component.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input")
+	bool bQueueInputEvents{ false };
+
+	//
+	// Maximum number of input events that can be queued in a frame, events beyond this will flush the queue
+	//
+	static constexpr int32 InputEventQueueSize{ 16 };
+
+	//
+	// Ring buffer of input events queued this frame
+	//
+	TStaticArray<FAbilityQueuedInputEvent, InputEventQueueSize> InputEventQueue;
+
+	int32 InputEventQueueHead{ 0 };
+	int32 InputEventQueueNum{ 0 };
+
+protected:
+	void EnqueueInputEvent(const FGameplayTag& InputTag, bool bPressed);
+
+	/**
+	 * Process press and release of abilities according to the tag.
+	 * 
+	 * Tips:
+	 *	If InOutActivatedHandles is specified, abilities listed in it will not be activated again and newly activated ones are added to it.
+	 */
+	void ProcessInputTagPressed(const FGameplayTag& InputTag, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>>* InOutActivatedHandles);
+	void ProcessInputTagReleased(const FGameplayTag& InputTag);
+
+public:
+	/**
+	 * Process all queued input events
+	 */
+	void ProcessQueuedInputEvents();
+
+
+protected:
+	//
+	// Maximum number of input presses that can be buffered, the oldest one is discarded when exceeded
+	//
+	static constexpr int32 InputBufferSize{ 8 };
+
+	//
+	// Ring buffer of input presses that failed to activate abilities with InputBufferWindow
+	//
+	TStaticArray<FAbilityBufferedInput, InputBufferSize> InputBuffer;
+
+	int32 InputBufferHead{ 0 };
+	int32 InputBufferNum{ 0 };
+
+protected:
+	/**
+	 * Adds the input press to the buffer, replacing the one already buffered for the same ability
+	 */
+	void BufferInput(const FAbilityBufferedInput& Input);
+	void RemoveBufferedInput(const FGameplayAbilitySpecHandle& Handle);
+
+public:
+	/**
+	 * Try activate abilities of the buffered input presses, and discard the expired ones
+	 */
+	void ProcessBufferedInput();
+
+	/**
+	 * Discard all buffered input presses
+	 */
+	void ClearInputBuffer();
+
+
+protected:
+	//
+	// Whether to retry "WhileInput" activation policy abilities only when something that could change the result happens
+	// (ability ends, cooldown ends, owned tags change, ability tags are unblocked or costs change), instead of every tick while the input is held.
+	// 
+	// Tips:
+	//	When enabled, this component does not need to tick while input is held.
+	//	Buffered input presses are always retried this way.
+	// 
+	// Note:
+	//	Cost changes made outside of the costs (e.g, picking up ammo) must be notified with NotifyAbilityCostChanged().
+	//	Abilities that failed for a reason not notified by any event are retried on the next tick until they stop failing for it.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input")
+	bool bEventDrivenHeldInput{ false };
+
+	//
+	// Whether a retry of the held and buffered input has been scheduled for the next tick
+	//
+	bool bInputRetryPending{ false };
+
+	//
+	// Reasons why the activation of held or buffered input abilities failed.
+	// They are not retried until an event matching the reason happens.
+	//
+	TMap<FGameplayAbilitySpecHandle, EAbilityActivateFailFlags> ParkedActivations;
+
+	//
+	// Last activation failure notified, used to park the activation that caused it
+	//
+	FGameplayAbilitySpecHandle LastFailedActivationHandle;
+	EAbilityActivateFailFlags LastFailedActivationFlags{ EAbilityActivateFailFlags::None };
+
+protected:
+	virtual void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
+	virtual void OnTagUpdated(const FGameplayTag& Tag, bool TagExists) override;
+
+	/**
+	 * Schedules a retry of the buffered input and, in event driven mode, of the held input abilities for the next tick
+	 */
+	void RequestInputRetry();
+	void HandleInputRetry();
+
+	/**
+	 * Try activate the ability of held or buffered input, and park it if it failed for a reason that is notified by an event
+	 */
+	bool TryActivatePendingAbility(const FGameplayAbilitySpecHandle& Handle);
+	void ParkActivation(const FGameplayAbilitySpecHandle& Handle, EAbilityActivateFailFlags FailureFlags);
+	bool IsActivationParked(const FGameplayAbilitySpecHandle& Handle) const;
+
+	/**
+	 * Wakes the parked activations that failed for any of the reasons so that they are retried
+	 */
+	void WakeParkedActivations(EAbilityActivateFailFlags WakeFlags);
+
+public:
+	/**
+	 * Notify that the cooldown of the ability has started
+	 */
+	void NotifyAbilityCooldownStarted(const FGameplayAbilitySpecHandle& Handle);
+
+	/**
+	 * Notify that the cooldown of the ability has ended
+	 */
+	void NotifyAbilityCooldownEnded(const FGameplayAbilitySpecHandle& Handle);
+
+	/**
+	 * Notify that a value used to pay ability costs (e.g. stat tag stack on the cost target) has changed
+	 * 
+	 * Tips:
+	 *	Costs notify the changes they make by themselves (e.g, UAbilityCost_StatTag::ApplyCost()).
+	 *	Call this when the cost target is changed by something else (e.g, picking up ammo, stacks replicated to clients)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Costs")
+	void NotifyAbilityCostChanged();
+
+protected:
+	//
+	// Attributes modified by the cost GameplayEffects of granted abilities that are being listened for
+	//
+	TSet<FGameplayAttribute> ObservedCostAttributes;
+
+protected:
+	/**
+	 * Listens for changes of the attributes modified by the cost GameplayEffect of the ability
+	 */
+	void ObserveCostAttributes(const UGameplayAbility* Ability);
+	void HandleCostAttributeChanged(const FOnAttributeChangeData& ChangeData);
+
+protected:
+	//
+	// Cost targets of UAbilityCost_StatTag resolved for each ability spec
+	// 
+	// Tips:
+	//	Held by the AbilitySystemComponent instead of the cost so that abilities can be NonInstanced.
+	//	Only modified when abilities are given or removed and when the avatar is set, never while checking or applying costs.
+	//
+	TMap<FGameplayAbilitySpecHandle, FStatTagCostTargets> SpecStatTagCostTargets;
+
+public:
+	void SetSpecStatTagCostTargets(const FGameplayAbilitySpecHandle& Handle, const FStatTagCostTargets& Targets) { SpecStatTagCostTargets.Add(Handle, Targets); }
+	const FStatTagCostTargets* FindSpecStatTagCostTargets(const FGameplayAbilitySpecHandle& Handle) const { return SpecStatTagCostTargets.Find(Handle); }
+
+
+protected:
+	//
+	// Cooldown state of each ability spec that has started a cooldown
+	//
+	TMap<FGameplayAbilitySpecHandle, FAbilitySpecCooldownState> SpecCooldownStates;
+
+	//
+	// Specs of GAE abilities that use cooldowns, by their ability CDO which is the ability in the context of the cooldown GameplayEffect
+	//
+	TMap<TObjectKey<UGameplayAbility>, TArray<FAbilitySpecIndexEntry, TInlineAllocator<1>>> CooldownSpecEntries;
+
+protected:
+	/**
+	 * Routes the added GameplayEffect to the cooldown handler of the ability that applied it
+	 * 
+	 * Tips:
+	 *	Bound once per AbilitySystemComponent instead of once per ability,
+	 *	so applying a GameplayEffect does not scale with the number of abilities that use cooldowns.
+	 */
+	void HandleCooldownEffectAdded(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle ActiveHandle);
+
+	/**
+	 * Returns the ability that handles the cooldown of the ability spec, the instance if instanced and the CDO otherwise
+	 */
+	UGAEGameplayAbility* GetCooldownHandlerAbility(const FGameplayAbilitySpec& AbilitySpec) const;
+
+public:
+	FAbilitySpecCooldownState& FindOrAddSpecCooldownState(const FGameplayAbilitySpecHandle& Handle) { return SpecCooldownStates.FindOrAdd(Handle); }
+	FAbilitySpecCooldownState* FindSpecCooldownState(const FGameplayAbilitySpecHandle& Handle) { return SpecCooldownStates.Find(Handle); }
+	const FAbilitySpecCooldownState* FindSpecCooldownState(const FGameplayAbilitySpecHandle& Handle) const { return SpecCooldownStates.Find(Handle); }
+
+
+protected:
+	//
+	// Cooldowns of the abilities that use EAbilityCooldownMode::Timestamp
+	//
+	UPROPERTY(Replicated)
+	FAbilityCooldownTimestampContainer CooldownTimestamps;
+
+	//
+	// Serial of the latest timer scheduled on UAbilityCooldownTimerSubsystem for the next timestamp cooldown to get a charge back,
+	// or to be removed on the server
+	//
+	uint32 CooldownTimerSerial{ 0 };
+
+protected:
+	/**
+	 * Starts or ends the cooldown of the ability spec depending on whether a charge is available now.
+	 * Runs on both the server and the clients.
+	 */
+	void HandleTimestampCooldownUpdated(const FAbilityCooldownTimestamp& Timestamp);
+	void HandleTimestampCooldownRemoved(const FGameplayAbilitySpecHandle& Handle);
+
+	void BeginSpecCooldown(const FGameplayAbilitySpecHandle& Handle, double StartTime, double EndTime);
+	void EndSpecCooldown(const FGameplayAbilitySpecHandle& Handle);
+
+	/**
+	 * Sets the timer to the next time a timestamp cooldown gets a charge back or is removed
+	 */
+	void ScheduleTimestampCooldownTimer();
+	void HandleTimestampCooldownTimer();
+
+	/**
+	 * Called by UAbilityCooldownTimerSubsystem, ignores the timers that have been rescheduled
+	 */
+	void HandleCooldownTimerExpired(uint32 Serial);
+
+public:
+	/**
+	 * Uses a charge of the timestamp cooldown of the ability spec (Authority only)
+	 * 
+	 * Tips:
+	 *	With a single charge, this is the same as starting a cooldown of RechargeInterval.
+	 */
+	void StartTimestampCooldown(const FGameplayAbilitySpecHandle& Handle, float RechargeInterval, int32 MaxCharges = 1);
+
+	/**
+	 * Ends the timestamp cooldown of the ability spec before it expires (Authority only)
+	 */
+	void ClearTimestampCooldown(const FGameplayAbilitySpecHandle& Handle);
+
+	const FAbilityCooldownTimestamp* FindTimestampCooldown(const FGameplayAbilitySpecHandle& Handle) const { return CooldownTimestamps.Find(Handle); }
+
+	/**
+	 * Returns the remaining time of the cooldown of the ability spec, or 0 if it is not in progress
+	 * 
+	 * Tips:
+	 *	Reads the end time recorded when the cooldown started, so it is cheap enough to call every frame.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cooldowns")
+	float GetAbilityCooldownTimeRemaining(FGameplayAbilitySpecHandle Handle) const;
+
+	/**
+	 * Returns how much of the cooldown of the ability spec has elapsed from 0 to 1, or 1 if it is not in progress
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cooldowns")
+	float GetAbilityCooldownProgress(FGameplayAbilitySpecHandle Handle) const;
+
+	/**
+	 * Returns the world time synchronized with the server, which timestamp cooldowns are based on
+	 */
+	double GetServerWorldTimeSeconds() const;
+
+
+protected:
+	//
+	// Maximum number of activation requests sent with a single RPC, the server rejects larger batches
+	//
+	static constexpr int32 MaxServerActivationBatchSize{ 16 };
+
+	//
+	// Activation requests to the server that are held until the current batch ends
+	//
+	TArray<FAbilityBatchedActivationRequest, TInlineAllocator<4>> PendingServerActivationRequests;
+
+	//
+	// Number of nested BeginServerActivationBatch() calls
+	//
+	int32 ServerActivationBatchDepth{ 0 };
+
+public:
+	virtual void CallServerTryActivateAbility(FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey) override;
+	virtual void CallServerSetReplicatedTargetData(FGameplayAbilitySpecHandle AbilityHandle, FPredictionKey AbilityOriginalPredictionKey, const FGameplayAbilityTargetDataHandle& ReplicatedTargetDataHandle, FGameplayTag ApplicationTag, FPredictionKey CurrentPredictionKey) override;
+	virtual void CallServerEndAbility(FGameplayAbilitySpecHandle AbilityToEnd, FGameplayAbilityActivationInfo ActivationInfo, FPredictionKey PredictionKey) override;
+
+	/**
+	 * Send the held activation requests to the server
+	 * 
+	 * Tips:
+	 *	Call this before sending a server RPC that must be received after the activation of an ability activated in the current batch.
+	 */
+	void FlushServerActivationRequests();
+
+protected:
+	/** Try to activate multiple abilities on the server with a single RPC */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerTryActivateAbilities(const TArray<FAbilityBatchedActivationRequest>& Requests);
+	void ServerTryActivateAbilities_Implementation(const TArray<FAbilityBatchedActivationRequest>& Requests);
+	bool ServerTryActivateAbilities_Validate(const TArray<FAbilityBatchedActivationRequest>& Requests);
+
+public:
+	/**
+	 * Hold activation requests to the server until the matching EndServerActivationBatch() call,
+	 * and send them with a single RPC.
+	 * 
+	 * Tips:
+	 *	Used while processing input so that abilities bound to the same input tag are activated with a single RPC.
+	 * 
+	 * Note:
+	 *	Locally predicted abilities run their activation right after the request and may send other RPCs that the server must receive after it.
+	 *	The held requests are sent before the end, cancel and target data RPCs, 
+	 *	and the server keeps replicated events and target data cancellation until the ability activates.
+	 *	Cancellation is only caught for GAEGameplayAbility, so requests of other locally predicted abilities are not held.
+	 */
+	void BeginServerActivationBatch();
+	void EndServerActivationBatch();
+
 
 public:
 	template <class T>
@@ -159,3 +1119,25 @@ public:
 	}
 
 };
+
+
+/**
+ * Defers activation of "OnSpawn" abilities granted to the AbilitySystemComponent while this scope is alive,
+ * so that they are activated in a single pass at the end of the scope instead of once per grant.
+ * 
+ * Note:
+ *	Does nothing if the AbilitySystemComponent is not a UGAEAbilitySystemComponent.
+ */
+struct GAEXT_API FScopedOnSpawnActivationDeferral
+{
+public:
+	explicit FScopedOnSpawnActivationDeferral(UAbilitySystemComponent* InASC);
+	~FScopedOnSpawnActivationDeferral();
+
+	FScopedOnSpawnActivationDeferral(const FScopedOnSpawnActivationDeferral&) = delete;
+	FScopedOnSpawnActivationDeferral& operator=(const FScopedOnSpawnActivationDeferral&) = delete;
+
+private:
+	TWeakObjectPtr<UGAEAbilitySystemComponent> ASC;
+
+};
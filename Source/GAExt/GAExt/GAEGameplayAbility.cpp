@@ -10,6 +10,7 @@
 #include "Type/AbilityFailureMessageTypes.h"
 #include "Type/AbilityCooldownMessageTypes.h"
 #include "Type/AbilityActivationMessageTypes.h"
+#include "Type/AbilityActivationStatTypes.h"
 #include "GAExtLogs.h"
 #include "GAExtStatGroup.h"
 
@@ -22,6 +23,22 @@
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GAEGameplayAbility)
 
 
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() AvatarRole"), STAT_UGAEGameplayAbility_CanActivateAbility_AvatarRole, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() Inhibition"), STAT_UGAEGameplayAbility_CanActivateAbility_Inhibition, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() Cooldown"), STAT_UGAEGameplayAbility_CanActivateAbility_Cooldown, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() Cost"), STAT_UGAEGameplayAbility_CanActivateAbility_Cost, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() TagRequirements"), STAT_UGAEGameplayAbility_CanActivateAbility_TagRequirements, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() InputBlock"), STAT_UGAEGameplayAbility_CanActivateAbility_InputBlock, STATGROUP_Ability);
+DECLARE_CYCLE_STAT(TEXT("UGAEGameplayAbility::CanActivateAbility() BlueprintCanActivate"), STAT_UGAEGameplayAbility_CanActivateAbility_BlueprintCanActivate, STATGROUP_Ability);
+
+/**
+ * Measures a stage of CanActivateAbility() with both the stat system and the per-ability-class counters
+ */
+#define SCOPE_ABILITY_ACTIVATION_STAGE(Recorder, Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_UGAEGameplayAbility_CanActivateAbility_##Stage); \
+	FAbilityActivationStageScope StageScope{ Recorder, EAbilityActivationStage::Stage }
+
+
 UGAEGameplayAbility::UGAEGameplayAbility(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -50,16 +67,29 @@ void UGAEGameplayAbility::OnGiveAbility(const FGameplayAbilityActorInfo* ActorIn
 {
 	Super::OnGiveAbility(ActorInfo, Spec);
 
-	ListenToCooldown(ActorInfo);
+	for (const auto& Cost : AdditionalCosts)
+	{
+		if (Cost)
+		{
+			Cost->OnGiveAbility(this, ActorInfo, Spec);
+		}
+	}
 
 	BP_OnGiveAbility();
 
-	TryActivateAbilityOnSpawn(ActorInfo, Spec);
+	// UGAEAbilitySystemComponent tries to activate "OnSpawn" abilities by itself so that bulk grants are activated in a single pass.
+
+	const auto* GAEASC{ ActorInfo ? Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr };
+
+	if (!GAEASC)
+	{
+		TryActivateAbilityOnSpawn(ActorInfo, Spec);
+	}
 }
 
 void UGAEGameplayAbility::OnRemoveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
 {
-	UnlistenToCooldown(ActorInfo);
+	UnlistenToCooldown(ActorInfo, Spec.Handle);
 
 	for (const auto& Cost : AdditionalCosts)
 	{
@@ -74,6 +104,17 @@ void UGAEGameplayAbility::OnRemoveAbility(const FGameplayAbilityActorInfo* Actor
 	Super::OnRemoveAbility(ActorInfo, Spec);
 }
 
+void UGAEGameplayAbility::OnAbilityLevelChanged(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
+{
+	for (const auto& Cost : AdditionalCosts)
+	{
+		if (Cost)
+		{
+			Cost->OnAbilityLevelChanged(this, ActorInfo, Spec);
+		}
+	}
+}
+
 void UGAEGameplayAbility::OnAvatarSet(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
 {
 	for (const auto& Cost : AdditionalCosts)
@@ -94,11 +135,23 @@ void UGAEGameplayAbility::OnAvatarSet(const FGameplayAbilityActorInfo* ActorInfo
 
 void UGAEGameplayAbility::ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData)
 {
-	BroadcastActivationMassage();
+	BroadcastActivationMassage(Handle, ActorInfo);
 
 	Super::ActivateAbility(Handle, ActorInfo, ActivationInfo, TriggerEventData);
 }
 
+void UGAEGameplayAbility::CancelAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, bool bReplicateCancelAbility)
+{
+	// The server must receive the activation request held by the ability system component before the cancellation
+
+	if (auto* GAEASC{ (bReplicateCancelAbility && ActorInfo) ? Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr })
+	{
+		GAEASC->FlushServerActivationRequests();
+	}
+
+	Super::CancelAbility(Handle, ActorInfo, ActivationInfo, bReplicateCancelAbility);
+}
+
 
 bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayTagContainer* SourceTags, const FGameplayTagContainer* TargetTags, OUT FGameplayTagContainer* OptionalRelevantTags) const
 {
@@ -113,18 +166,23 @@ bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Ha
 	 // Don't set the actor info, CanActivate is called on the CDO
 	////////////////////////////////////////////////////////////////
 
+	FAbilityActivationStatsRecorder StatsRecorder{ GetClass() };
+
 	// A valid AvatarActor is required. Simulated proxy check means only authority or autonomous proxies should be executing abilities.
 
 	auto* const AvatarActor{ ActorInfo ? ActorInfo->AvatarActor.Get() : nullptr };
-	if (AvatarActor == nullptr || !ShouldActivateAbility(AvatarActor->GetLocalRole()))
 	{
-		return false;
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, AvatarRole);
+
+		if (!StageScope.Passed(AvatarActor != nullptr && ShouldActivateAbility(AvatarActor->GetLocalRole())))
+		{
+			return false;
+		}
 	}
 
 	// Make into a reference for simplicity
 
-	static FGameplayTagContainer DummyContainer;
-	DummyContainer.Reset();
+	FGameplayTagContainer DummyContainer;
 
 	auto& OutTags{ OptionalRelevantTags ? *OptionalRelevantTags : DummyContainer };
 
@@ -136,18 +194,22 @@ bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Ha
 		return false;
 	}
 
-	if (AbilitySystemComponent->GetUserAbilityActivationInhibited())
 	{
-		/**
-		 *	Input is inhibited (UI is pulled up, another ability may be blocking all other input, etc).
-		 *	When we get into triggered abilities, we may need to better differentiate between CanActivate and CanUserActivate or something.
-		 *	E.g., we would want LMB/RMB to be inhibited while the user is in the menu UI, but we wouldn't want to prevent a 'buff when I am low health'
-		 *	ability to not trigger.
-		 *
-		 *	Basically: CanActivateAbility is only used by user activated abilities now. If triggered abilities need to check costs/cooldowns, then we may
-		 *	want to split this function up and change the calling API to distinguish between 'can I initiate an ability activation' and 'can this ability be activated'.
-		 */
-		return false;
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, Inhibition);
+
+		if (!StageScope.Passed(!AbilitySystemComponent->GetUserAbilityActivationInhibited()))
+		{
+			/**
+			 *	Input is inhibited (UI is pulled up, another ability may be blocking all other input, etc).
+			 *	When we get into triggered abilities, we may need to better differentiate between CanActivate and CanUserActivate or something.
+			 *	E.g., we would want LMB/RMB to be inhibited while the user is in the menu UI, but we wouldn't want to prevent a 'buff when I am low health'
+			 *	ability to not trigger.
+			 *
+			 *	Basically: CanActivateAbility is only used by user activated abilities now. If triggered abilities need to check costs/cooldowns, then we may
+			 *	want to split this function up and change the calling API to distinguish between 'can I initiate an ability activation' and 'can this ability be activated'.
+			 */
+			return false;
+		}
 	}
 
 	///
@@ -156,27 +218,32 @@ bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Ha
 
 	auto& AbilitySystemGlobals{ UAbilitySystemGlobals::Get() };
 
-	const auto bCooldownReady{ AbilitySystemGlobals.ShouldIgnoreCooldowns() || CheckCooldown(Handle, ActorInfo, OptionalRelevantTags) };
-	const auto bCostsReady{ AbilitySystemGlobals.ShouldIgnoreCosts() || CheckCost(Handle, ActorInfo, OptionalRelevantTags) };
+	// Use the flags read once for the whole query if this is a part of QueryActivatableAbilities()
+
+	const auto* QueryContext{ FAbilityActivationQueryContext::Get(AbilitySystemComponent) };
+	const auto bIgnoreCooldowns{ QueryContext ? QueryContext->bIgnoreCooldowns : AbilitySystemGlobals.ShouldIgnoreCooldowns() };
+	const auto bIgnoreCosts{ QueryContext ? QueryContext->bIgnoreCosts : AbilitySystemGlobals.ShouldIgnoreCosts() };
+
+	// Check only what the activation policy enforces so that failure tags are not added for the ignored one
 
-	if (ActivationPolicy == EAbilityActivationPolicy::Default)
+	const auto bEnforceCooldown{ ActivationPolicy != EAbilityActivationPolicy::CostOverCooldown };
+	const auto bEnforceCosts{ ActivationPolicy != EAbilityActivationPolicy::CooldownOverCost };
+
+	if (bEnforceCooldown && !bIgnoreCooldowns)
 	{
-		if (!bCooldownReady || !bCostsReady)
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, Cooldown);
+
+		if (!StageScope.Passed(CheckCooldown(Handle, ActorInfo, OptionalRelevantTags)))
 		{
 			return false;
 		}
 	}
-	else if (ActivationPolicy == EAbilityActivationPolicy::CostOverCooldown)
-	{
-		if (!bCostsReady)
-		{
-			return false;
-		}
 
-	}
-	else if (ActivationPolicy == EAbilityActivationPolicy::CooldownOverCost)
+	if (bEnforceCosts && !bIgnoreCosts)
 	{
-		if (!bCooldownReady)
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, Cost);
+
+		if (!StageScope.Passed(CheckCost(Handle, ActorInfo, OptionalRelevantTags)))
 		{
 			return false;
 		}
@@ -188,13 +255,17 @@ bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Ha
 
 	// If the ability's tags are blocked, or if it has a "Blocking" tag or is missing a "Required" tag, then it can't activate.
 
-	if (!DoesAbilitySatisfyTagRequirements(*AbilitySystemComponent, SourceTags, TargetTags, OptionalRelevantTags))
-	{	
-		/*if (FScopedCanActivateAbilityLogEnabler::IsLoggingEnabled())
-		{
-			ABILITY_VLOG(ActorInfo->OwnerActor.Get(), Verbose, TEXT("Ability could not be activated due to Blocking Tags or Missing Required Tags: %s"), *GetName());
-		}*/
-		return false;
+	{
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, TagRequirements);
+
+		if (!StageScope.Passed(DoesAbilitySatisfyTagRequirements(*AbilitySystemComponent, SourceTags, TargetTags, OptionalRelevantTags)))
+		{	
+			/*if (FScopedCanActivateAbilityLogEnabler::IsLoggingEnabled())
+			{
+				ABILITY_VLOG(ActorInfo->OwnerActor.Get(), Verbose, TEXT("Ability could not be activated due to Blocking Tags or Missing Required Tags: %s"), *GetName());
+			}*/
+			return false;
+		}
 	}
 
 	auto* Spec{ AbilitySystemComponent->FindAbilitySpecFromHandle(Handle) };
@@ -206,18 +277,24 @@ bool UGAEGameplayAbility::CanActivateAbility(const FGameplayAbilitySpecHandle Ha
 
 	// Check if this ability's input binding is currently blocked
 
-	if (AbilitySystemComponent->IsAbilityInputBlocked(Spec->InputID))
 	{
-		/*if (FScopedCanActivateAbilityLogEnabler::IsLoggingEnabled())
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, InputBlock);
+
+		if (!StageScope.Passed(!AbilitySystemComponent->IsAbilityInputBlocked(Spec->InputID)))
 		{
-			ABILITY_VLOG(ActorInfo->OwnerActor.Get(), Verbose, TEXT("Ability could not be activated due to blocked input ID %i: %s"), Spec->InputID, *GetName());
-		}*/
-		return false;
+			/*if (FScopedCanActivateAbilityLogEnabler::IsLoggingEnabled())
+			{
+				ABILITY_VLOG(ActorInfo->OwnerActor.Get(), Verbose, TEXT("Ability could not be activated due to blocked input ID %i: %s"), Spec->InputID, *GetName());
+			}*/
+			return false;
+		}
 	}
 
 	if (bHasBlueprintCanUse)
 	{
-		if (K2_CanActivateAbility(*ActorInfo, Handle, OutTags) == false)
+		SCOPE_ABILITY_ACTIVATION_STAGE(StatsRecorder, BlueprintCanActivate);
+
+		if (!StageScope.Passed(K2_CanActivateAbility(*ActorInfo, Handle, OutTags)))
 		{
 			//ABILITY_LOG(Log, TEXT("CanActivateAbility %s failed, blueprint refused"), *GetName());
 			return false;
@@ -238,36 +315,41 @@ bool UGAEGameplayAbility::DoesAbilitySatisfyTagRequirements(const UAbilitySystem
 	const auto& BlockedTag{ AbilitySystemGlobals.ActivateFailTagsBlockedTag };
 	const auto& MissingTag{ AbilitySystemGlobals.ActivateFailTagsMissingTag };
 
-	// Check if any of this ability's tags are currently blocked
+	// Use our ability tags expanded with additional required/blocked tags, which are cached by the ASC
 
-	if (AbilitySystemComponent.AreAbilityTagsBlocked(AbilityTags))
-	{
-		bBlocked = true;
-	}
-
-	static FGameplayTagContainer AllRequiredTags;
-	static FGameplayTagContainer AllBlockedTags;
+	const auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(&AbilitySystemComponent) };
+	const auto* Requirements{ GAEASC ? &GAEASC->GetActivationTagRequirements(*this) : nullptr };
 
-	AllRequiredTags = ActivationRequiredTags;
-	AllBlockedTags = ActivationBlockedTags;
+	if (Requirements && Requirements->bTagBitsValid && GAEASC->CanUseTagBitSets())
+	{
+		// Check with the tag bit sets kept by the ASC
 
-	// Expand our ability tags to add additional required/blocked tags
+		const auto& OwnedTagBits{ GAEASC->GetOwnedTagBits() };
 
-	if (const auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(&AbilitySystemComponent) })
-	{
-		GAEASC->GetAdditionalActivationTagRequirements(AbilityTags, AllRequiredTags, AllBlockedTags);
+		bBlocked = GAEASC->GetBlockedAbilityTagBits().HasAny(Requirements->AbilityTagBits) || OwnedTagBits.HasAny(Requirements->BlockedTagBits);
+		bMissing = !OwnedTagBits.HasAll(Requirements->RequiredTagBits);
 	}
+	else
+	{
+		// Check if any of this ability's tags are currently blocked
+
+		if (AbilitySystemComponent.AreAbilityTagsBlocked(AbilityTags))
+		{
+			bBlocked = true;
+		}
 
-	// Check to see the required/blocked tags for this ability
+		const auto& AllRequiredTags{ Requirements ? Requirements->RequiredTags : ActivationRequiredTags };
+		const auto& AllBlockedTags{ Requirements ? Requirements->BlockedTags : ActivationBlockedTags };
 
-	if (AllBlockedTags.Num() || AllRequiredTags.Num())
-	{
-		static FGameplayTagContainer AbilitySystemComponentTags;
+		// Check to see the required/blocked tags for this ability.
+		// Query the tag counts of the ASC directly instead of copying the owned tags.
 
-		AbilitySystemComponentTags.Reset();
-		AbilitySystemComponent.GetOwnedGameplayTags(AbilitySystemComponentTags);
+		if (AllBlockedTags.Num() && AbilitySystemComponent.HasAnyMatchingGameplayTags(AllBlockedTags))
+		{
+			bBlocked = true;
+		}
 
-		if (!AbilitySystemComponentTags.HasAll(AllRequiredTags))
+		if (AllRequiredTags.Num() && !AbilitySystemComponent.HasAllMatchingGameplayTags(AllRequiredTags))
 		{
 			bMissing = true;
 		}
@@ -356,25 +438,36 @@ void UGAEGameplayAbility::TryActivateAbilityOnSpawn(const FGameplayAbilityActorI
 }
 
 
-void UGAEGameplayAbility::BroadcastActivationMassage() const
+void UGAEGameplayAbility::BroadcastActivationMassage(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const
 {
-	if (ActivationMessageTag.IsValid())
+	// Read everything from the actor info since NonInstanced abilities have no current actor info.
+
+	if (ActorInfo && ActivationMessageTag.IsValid())
 	{
 		if (bActivationMessageLocallyOnly)
 		{
-			if (!IsLocallyControlled())
+			if (!ActorInfo->IsLocallyControlled())
 			{
 				return;
 			}
 		}
 
+		const auto* ASC{ ActorInfo->AbilitySystemComponent.Get() };
+		const auto* Spec{ ASC ? ASC->FindAbilitySpecFromHandle(Handle) : nullptr };
+		auto* OwnerActor{ ActorInfo->OwnerActor.Get() };
+
+		if (!OwnerActor)
+		{
+			return;
+		}
+
 		FAbilityActivationMessage Message;
 		Message.Ability = this;
-		Message.OwnerActor = GetOwningActorFromActorInfo();
-		Message.AvatarActor = GetAvatarActorFromActorInfo();
-		Message.SourceObject = GetCurrentSourceObject();
+		Message.OwnerActor = OwnerActor;
+		Message.AvatarActor = ActorInfo->AvatarActor.Get();
+		Message.SourceObject = Spec ? Spec->SourceObject.Get() : nullptr;
 
-		auto& MessageSubsystem{ UGameplayMessageSubsystem::Get(GetWorld()) };
+		auto& MessageSubsystem{ UGameplayMessageSubsystem::Get(OwnerActor->GetWorld()) };
 		MessageSubsystem.BroadcastMessage(ActivationMessageTag, Message);
 	}
 }
@@ -396,9 +489,18 @@ bool UGAEGameplayAbility::CommitAbilityCooldown(const FGameplayAbilitySpecHandle
 
 bool UGAEGameplayAbility::CheckCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, OUT FGameplayTagContainer* OptionalRelevantTags) const
 {
-	if (IsCooldownAvailable())
+	const auto* CooldownState{ IsCooldownAvailable() ? GetCooldownState(Handle, ActorInfo) : nullptr };
+
+	if (CooldownState && CooldownState->bCoolingdown)
 	{
-		return !bCoolingdown;
+		const auto& CooldownTag{ UAbilitySystemGlobals::Get().ActivateFailCooldownTag };
+
+		if (OptionalRelevantTags && CooldownTag.IsValid())
+		{
+			OptionalRelevantTags->AddTag(CooldownTag);
+		}
+
+		return false;
 	}
 
 	return true;
@@ -408,7 +510,14 @@ void UGAEGameplayAbility::ApplyCooldown(const FGameplayAbilitySpecHandle Handle,
 {
 	if (IsCooldownAvailable())
 	{
-		if (ActorInfo->IsNetAuthority())
+		if (CooldownMode == EAbilityCooldownMode::Timestamp)
+		{
+			if (auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) })
+			{
+				GAEASC->StartTimestampCooldown(Handle, CooltimeOverride, MaxCharges);
+			}
+		}
+		else if (ActorInfo->IsNetAuthority())
 		{
 			auto SpecHandle
 			{
@@ -429,6 +538,39 @@ void UGAEGameplayAbility::ApplyCooldown(const FGameplayAbilitySpecHandle Handle,
 	}
 }
 
+int32 UGAEGameplayAbility::GetRemainingCharges(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	const auto* GAEASC{ ActorInfo ? Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr };
+
+	if (!IsCooldownAvailable() || !GAEASC)
+	{
+		return 1;
+	}
+
+	if (CooldownMode == EAbilityCooldownMode::Timestamp)
+	{
+		const auto* Timestamp{ GAEASC->FindTimestampCooldown(Handle) };
+
+		return Timestamp ? Timestamp->GetCharges(GAEASC->GetServerWorldTimeSeconds()) : MaxCharges;
+	}
+
+	const auto* CooldownState{ GAEASC->FindSpecCooldownState(Handle) };
+
+	return (CooldownState && CooldownState->bCoolingdown) ? 0 : 1;
+}
+
+int32 UGAEGameplayAbility::BP_GetRemainingCharges() const
+{
+	return GetRemainingCharges(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo());
+}
+
+float UGAEGameplayAbility::BP_GetCooldownProgress() const
+{
+	const auto* GAEASC{ GetAbilitySystemComponent<UGAEAbilitySystemComponent>() };
+
+	return GAEASC ? GAEASC->GetAbilityCooldownProgress(GetCurrentAbilitySpecHandle()) : 1.0f;
+}
+
 
 bool UGAEGameplayAbility::IsCooldownAvailable() const
 {
@@ -441,7 +583,7 @@ bool UGAEGameplayAbility::IsCooldownAvailable() const
 
 	// If cooldown class not set, return false
 
-	if (!CooldownGameplayEffectClass)
+	if ((CooldownMode == EAbilityCooldownMode::GameplayEffect) && !CooldownGameplayEffectClass)
 	{
 		return false;
 	}
@@ -456,47 +598,58 @@ bool UGAEGameplayAbility::IsCooldownAvailable() const
 	return true;
 }
 
-void UGAEGameplayAbility::BroadcastCooldownMassage(float Duration) const
+void UGAEGameplayAbility::BroadcastCooldownMassage(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float Duration) const
 {
-	if (IsLocallyControlled() && CooldownMessageTag.IsValid())
+	// Read everything from the actor info since NonInstanced abilities have no current actor info.
+
+	if (ActorInfo && ActorInfo->IsLocallyControlled() && CooldownMessageTag.IsValid())
 	{
+		const auto* ASC{ ActorInfo->AbilitySystemComponent.Get() };
+		const auto* Spec{ ASC ? ASC->FindAbilitySpecFromHandle(Handle) : nullptr };
+		auto* OwnerActor{ ActorInfo->OwnerActor.Get() };
+
+		if (!OwnerActor)
+		{
+			return;
+		}
+
 		FAbilityCooldownMessage Message;
 		Message.Ability = this;
-		Message.OwnerActor = GetOwningActorFromActorInfo();
-		Message.AvatarActor = GetAvatarActorFromActorInfo();
-		Message.SourceObject = GetCurrentSourceObject();
+		Message.OwnerActor = OwnerActor;
+		Message.AvatarActor = ActorInfo->AvatarActor.Get();
+		Message.SourceObject = Spec ? Spec->SourceObject.Get() : nullptr;
 		Message.Duration = Duration;
+
+		if (const auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(ASC) })
+		{
+			const auto* CooldownState{ GAEASC->FindSpecCooldownState(Handle) };
+
+			Message.EndTime = CooldownState ? CooldownState->EndTime : (GAEASC->GetServerWorldTimeSeconds() + Duration);
+		}
 	
-		auto& MessageSubsystem{ UGameplayMessageSubsystem::Get(GetWorld()) };
+		auto& MessageSubsystem{ UGameplayMessageSubsystem::Get(OwnerActor->GetWorld()) };
 		MessageSubsystem.BroadcastMessage(CooldownMessageTag, Message);
 	}
 }
 
-
-void UGAEGameplayAbility::ListenToCooldown(const FGameplayAbilityActorInfo* ActorInfo)
+const FAbilitySpecCooldownState* UGAEGameplayAbility::GetCooldownState(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const
 {
-	if (bUseCooldown)
-	{
-		auto ASC{ ActorInfo->AbilitySystemComponent };
-		if (ASC.IsValid())
-		{
-			ASC->OnActiveGameplayEffectAddedDelegateToSelf.AddUObject(this, &ThisClass::HandleAnyGameplayEffectAdded);
-		}
-	}
+	const auto* GAEASC{ ActorInfo ? Cast<UGAEAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr };
+
+	return GAEASC ? GAEASC->FindSpecCooldownState(Handle) : nullptr;
 }
 
-void UGAEGameplayAbility::UnlistenToCooldown(const FGameplayAbilityActorInfo* ActorInfo)
+
+void UGAEGameplayAbility::UnlistenToCooldown(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpecHandle Handle)
 {
 	if (bUseCooldown)
 	{
 		auto ASC{ ActorInfo->AbilitySystemComponent };
 		if (ASC.IsValid())
 		{
-			ASC->OnActiveGameplayEffectAddedDelegateToSelf.RemoveAll(this);
-
-			if (auto* Delegate{ ASC->OnGameplayEffectRemoved_InfoDelegate(CooldownGEHandle) })
+			if (const auto* CooldownState{ GetCooldownState(Handle, ActorInfo) })
 			{
-				Delegate->RemoveAll(this);
+				UnbindCooldownEffectDelegates(ASC.Get(), CooldownState->CooldownGEHandle);
 			}
 		}
 	}
@@ -509,51 +662,145 @@ bool UGAEGameplayAbility::IsCDGameplayEffectForThis(const FGameplayEffectSpec& S
 }
 
 
-void UGAEGameplayAbility::HandleAnyGameplayEffectAdded(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle Handle)
+void UGAEGameplayAbility::HandleCooldownEffectAdded(UGAEAbilitySystemComponent* GAEASC, const FGameplayAbilitySpecHandle SpecHandle, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle Handle)
 {
-	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("UGAEGameplayAbility::HandleAnyGameplayEffectAdded()"), STAT_UGAEGameplayAbility_HandleAnyGameplayEffectAdded, STATGROUP_Ability);
+	check(GAEASC);
+
+	auto& CooldownState{ GAEASC->FindOrAddSpecCooldownState(SpecHandle) };
 
-	if (IsCDGameplayEffectForThis(Spec))
+	if (CooldownState.CooldownGEHandle.IsValid())
 	{
-		OnCooldownStart(Spec.GetDuration());
+		UnbindCooldownEffectDelegates(GAEASC, CooldownState.CooldownGEHandle);
 
-		if (CooldownGEHandle.IsValid())
-		{
-			if (auto* Delegate{ ASC->OnGameplayEffectRemoved_InfoDelegate(Handle) })
-			{
-				Delegate->RemoveAll(this);
-			}
+		CooldownState.CooldownGEHandle.Invalidate();
+	}
 
-			CooldownGEHandle.Invalidate();
-		}
+	if (auto* Delegate{ GAEASC->OnGameplayEffectRemoved_InfoDelegate(Handle) })
+	{
+		Delegate->AddUObject(this, &ThisClass::HandleCDGameplayEffectRemoved, MakeWeakObjectPtr<UAbilitySystemComponent>(GAEASC), SpecHandle);
+	}
 
-		if (auto* Delegate{ ASC->OnGameplayEffectRemoved_InfoDelegate(Handle) })
-		{
-			Delegate->AddUObject(this, &ThisClass::HandleCDGameplayEffectRemoved);
-		}
+	if (auto* Delegate{ GAEASC->OnGameplayEffectTimeChangeDelegate(Handle) })
+	{
+		Delegate->AddUObject(this, &ThisClass::HandleCDGameplayEffectTimeChanged, MakeWeakObjectPtr<UAbilitySystemComponent>(GAEASC), SpecHandle);
+	}
 		
-		CooldownGEHandle = Handle;
+	// Record the times so that the remaining time can be read without looking up the active GameplayEffect.
+	// Use the server time when the GameplayEffect started, since on clients it may be added long after that (e.g, late join, relevancy).
+
+	const auto CurrentTime{ GAEASC->GetServerWorldTimeSeconds() };
+	const auto* ActiveEffect{ GAEASC->GetActiveGameplayEffect(Handle) };
+
+	const auto StartTime{ ActiveEffect ? static_cast<double>(ActiveEffect->StartServerWorldTime) : CurrentTime };
+	const auto Duration{ ActiveEffect ? ActiveEffect->GetDuration() : Spec.GetDuration() };
+
+	CooldownState.CooldownGEHandle = Handle;
+	CooldownState.Begin(StartTime, StartTime + FMath::Max(Duration, 0.0f));
+
+	DispatchCooldownStart(SpecHandle, GAEASC->AbilityActorInfo.Get(), CooldownState.GetRemainingTime(CurrentTime));
+
+	GAEASC->NotifyAbilityCooldownStarted(SpecHandle);
+}
+
+void UGAEGameplayAbility::HandleCDGameplayEffectRemoved(const FGameplayEffectRemovalInfo& Info, TWeakObjectPtr<UAbilitySystemComponent> WeakASC, FGameplayAbilitySpecHandle SpecHandle)
+{
+	auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(WeakASC.Get()) };
+
+	if (!GAEASC)
+	{
+		return;
+	}
+
+	if (auto* CooldownState{ GAEASC->FindSpecCooldownState(SpecHandle) })
+	{
+		CooldownState->CooldownGEHandle.Invalidate();
+		CooldownState->End();
+	}
+
+	DispatchCooldownEnd(SpecHandle, GAEASC->AbilityActorInfo.Get());
+
+	GAEASC->NotifyAbilityCooldownEnded(SpecHandle);
+}
+
+void UGAEGameplayAbility::HandleCDGameplayEffectTimeChanged(FActiveGameplayEffectHandle Handle, float NewStartTime, float NewDuration, TWeakObjectPtr<UAbilitySystemComponent> WeakASC, FGameplayAbilitySpecHandle SpecHandle)
+{
+	auto* GAEASC{ Cast<UGAEAbilitySystemComponent>(WeakASC.Get()) };
+
+	if (!GAEASC)
+	{
+		return;
+	}
+
+	// NewStartTime is in local world time, so read the server start time from the active GameplayEffect
+
+	auto* CooldownState{ GAEASC->FindSpecCooldownState(SpecHandle) };
+	const auto* ActiveEffect{ GAEASC->GetActiveGameplayEffect(Handle) };
+
+	if (CooldownState && CooldownState->bCoolingdown && (CooldownState->CooldownGEHandle == Handle) && ActiveEffect)
+	{
+		const auto StartTime{ static_cast<double>(ActiveEffect->StartServerWorldTime) };
+
+		CooldownState->Begin(StartTime, StartTime + FMath::Max(NewDuration, 0.0f));
+
+		BroadcastCooldownMassage(SpecHandle, GAEASC->AbilityActorInfo.Get(), CooldownState->GetRemainingTime(GAEASC->GetServerWorldTimeSeconds()));
+	}
+}
+
+void UGAEGameplayAbility::UnbindCooldownEffectDelegates(UAbilitySystemComponent* ASC, FActiveGameplayEffectHandle Handle)
+{
+	if (auto* Delegate{ ASC->OnGameplayEffectRemoved_InfoDelegate(Handle) })
+	{
+		Delegate->RemoveAll(this);
+	}
 
-		bCoolingdown = true;
+	if (auto* Delegate{ ASC->OnGameplayEffectTimeChangeDelegate(Handle) })
+	{
+		Delegate->RemoveAll(this);
 	}
 }
 
-void UGAEGameplayAbility::HandleCDGameplayEffectRemoved(const FGameplayEffectRemovalInfo& Info)
+
+void UGAEGameplayAbility::DispatchCooldownStart(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float Duration)
 {
-	bCoolingdown = false;
+	if (GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
+	{
+		OnCooldownStart(Duration);
+	}
+	else
+	{
+		BroadcastCooldownMassage(Handle, ActorInfo, Duration);
+	}
+}
 
-	OnCooldownEnd();
+void UGAEGameplayAbility::DispatchCooldownEnd(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo)
+{
+	if (GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
+	{
+		OnCooldownEnd();
+	}
+	else if (ActorInfo)
+	{
+		BroadcastCooldownMassage(Handle, ActorInfo, 0.0f);
+
+		for (const auto& Cost : AdditionalCosts)
+		{
+			if (Cost)
+			{
+				Cost->OnCooldownEnd(this, Handle, ActorInfo, FGameplayAbilityActivationInfo());
+			}
+		}
+	}
 }
 
 
 void UGAEGameplayAbility::OnCooldownStart_Implementation(float Duration)
 {
-	BroadcastCooldownMassage(Duration);
+	BroadcastCooldownMassage(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo(), Duration);
 }
 
 void UGAEGameplayAbility::OnCooldownEnd_Implementation()
 {
-	BroadcastCooldownMassage(0.0f);
+	BroadcastCooldownMassage(GetCurrentAbilitySpecHandle(), GetCurrentActorInfo(), 0.0f);
 
 	for (const auto& Cost : AdditionalCosts)
 	{
@@ -582,8 +829,19 @@ bool UGAEGameplayAbility::CheckCost(const FGameplayAbilitySpecHandle Handle, con
 	{
 		if (Cost)
 		{
+			const auto NumRelevantTags{ OptionalRelevantTags ? OptionalRelevantTags->Num() : 0 };
+
 			if (!Cost->CheckCost(this, Handle, ActorInfo, /*InOut*/ OptionalRelevantTags))
 			{
+				// Add the generic reason if the cost did not add its own
+
+				const auto& CostTag{ UAbilitySystemGlobals::Get().ActivateFailCostTag };
+
+				if (OptionalRelevantTags && CostTag.IsValid() && (OptionalRelevantTags->Num() == NumRelevantTags))
+				{
+					OptionalRelevantTags->AddTag(CostTag);
+				}
+
 				return false;
 			}
 		}
@@ -14,6 +14,7 @@ class ACharacter;
 class APawn;
 class AActor;
 class APlayerState;
+struct FAbilitySpecCooldownState;
 
 /**
  * Types of method that activate or deactivated abilities
@@ -60,6 +61,25 @@ enum class EAbilityActivationPolicy : uint8
 };
 
 
+/**
+ * How the cooldown of abilities is represented
+ */
+UENUM(BlueprintType)
+enum class EAbilityCooldownMode : uint8
+{
+	// Apply CooldownGameplayEffectClass as an active GameplayEffect
+	GameplayEffect,
+
+	// Only record the start and end time on the AbilitySystemComponent
+	// 
+	// Tips:
+	//	Lighter for abilities that are used frequently, since no GameplayEffect is created, applied or replicated.
+	//	The cooldown does not grant any tags and can not be modified by GameplayEffects.
+	//
+	Timestamp
+};
+
+
 /**
  * GameplayAbility with enhanced availability activation and other features
  */
@@ -70,6 +90,7 @@ class GAEXT_API UGAEGameplayAbility : public UGameplayAbility
 
 	friend class UGAEAbilitySystemComponent;
 	friend class UAbilityCost;
+	friend struct FAbilitySpecActivationFlags;
 
 public:
 	UGAEGameplayAbility(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
@@ -81,6 +102,11 @@ protected:
 	virtual void OnRemoveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) override;
 	virtual void OnAvatarSet(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) override;
 
+	/**
+	 * Called by UGAEAbilitySystemComponent when the level of the ability spec has changed after it was given
+	 */
+	virtual void OnAbilityLevelChanged(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec);
+
 	/** 
 	 * Called when this ability is granted to the ability system component. 
 	 */
@@ -116,6 +142,16 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Ability Activation")
 	EAbilityActivationPolicy ActivationPolicy{ EAbilityActivationPolicy::Default };
 
+	//
+	// Time in seconds during which an input press that failed to activate this ability is buffered and replayed 
+	// when the condition blocking it clears (e.g, other ability ends, cooldown ends, blocking tag removed)
+	// 
+	// Tips:
+	//	If 0, input presses that fail to activate are discarded.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Ability Activation", meta = (ClampMin = 0.00, Units = "s", EditCondition = "ActivationMethod == EAbilityActivationMethod::OnInputTriggered", EditConditionHides))
+	float InputBufferWindow{ 0.0f };
+
 	//
 	// Tag to be used when sending activation messages
 	// 
@@ -136,6 +172,7 @@ protected:
 
 public:
 	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
+	virtual void CancelAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, bool bReplicateCancelAbility) override;
 
 	virtual bool CanActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayTagContainer* SourceTags = nullptr, const FGameplayTagContainer* TargetTags = nullptr, OUT FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
 	virtual bool DoesAbilitySatisfyTagRequirements(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayTagContainer* SourceTags, const FGameplayTagContainer* TargetTags, OUT FGameplayTagContainer* OptionalRelevantTags) const override;
@@ -148,7 +185,7 @@ public:
 	/**
 	 * Broadcast the ability activation to the GameplayMessageSubsystem
 	 */
-	void BroadcastActivationMassage() const;
+	void BroadcastActivationMassage(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const;
 
 #pragma endregion
 
@@ -163,6 +200,21 @@ protected:
 	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Cooldowns")
 	bool bUseCooldown{ false };
 
+	//
+	// How the cooldown is represented
+	//
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Cooldowns", meta = (EditCondition = "bUseCooldown"))
+	EAbilityCooldownMode CooldownMode{ EAbilityCooldownMode::GameplayEffect };
+
+	//
+	// Number of times the ability can be used in a row
+	// 
+	// Tips:
+	//	Each use is recharged one by one after CooltimeOverride, and the cooldown is in progress only while no charge is left.
+	//
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Cooldowns", meta = (ClampMin = 1, ClampMax = 255, EditCondition = "bUseCooldown && CooldownMode == EAbilityCooldownMode::Timestamp"))
+	int32 MaxCharges{ 1 };
+
 	//
 	// Override the effect time of CooldownGameplayEffect.
 	// 
@@ -181,19 +233,32 @@ protected:
 	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Cooldowns", meta = (Categories = "Message.Ability.Cooldown", EditCondition = "bUseCooldown"))
 	FGameplayTag CooldownMessageTag;
 
-protected:
-	UPROPERTY(Transient)
-	FActiveGameplayEffectHandle CooldownGEHandle;
-
-	UPROPERTY(Transient)
-	bool bCoolingdown{ false };
-
 public:
 	virtual bool CommitAbilityCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const bool ForceCooldown, OUT FGameplayTagContainer* OptionalRelevantTags = nullptr) override;
 
 	virtual bool CheckCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, OUT FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
 	virtual void ApplyCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo) const override;
 
+	/**
+	 * Returns the number of charges available now
+	 * 
+	 * Tips:
+	 *	Abilities that do not use charges have a single charge, which is not available while the cooldown is in progress.
+	 */
+	int32 GetRemainingCharges(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Cooldowns", meta = (DisplayName = "GetRemainingCharges"))
+	int32 BP_GetRemainingCharges() const;
+
+	/**
+	 * Returns how much of the cooldown has elapsed from 0 to 1, or 1 if it is not in progress
+	 * 
+	 * Tips:
+	 *	Reads the times recorded on the AbilitySystemComponent instead of querying active GameplayEffects.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cooldowns", meta = (DisplayName = "GetCooldownProgress"))
+	float BP_GetCooldownProgress() const;
+
 protected:
 	/**
 	 * Returns whether Cooldown is available in the current configuration
@@ -206,11 +271,18 @@ protected:
 	 * Note:
 	 *	This broadcast is basically only performed by the local proxy
 	 */
-	void BroadcastCooldownMassage(float Duration) const;
+	void BroadcastCooldownMassage(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float Duration) const;
+
+	/**
+	 * Returns the cooldown state of the ability spec, which is held by the AbilitySystemComponent
+	 * 
+	 * Note:
+	 *	Cooldowns are not tracked if the AbilitySystemComponent is not a UGAEAbilitySystemComponent.
+	 */
+	const FAbilitySpecCooldownState* GetCooldownState(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo) const;
 
 protected:
-	void ListenToCooldown(const FGameplayAbilityActorInfo* ActorInfo);
-	void UnlistenToCooldown(const FGameplayAbilityActorInfo* ActorInfo);
+	void UnlistenToCooldown(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpecHandle Handle);
 
 	/**
 	 * Returns whether GameplayEffectSpec is related for this ability
@@ -218,8 +290,28 @@ protected:
 	virtual bool IsCDGameplayEffectForThis(const FGameplayEffectSpec& Spec) const;
 
 private:
-	void HandleAnyGameplayEffectAdded(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle Handle);
-	void HandleCDGameplayEffectRemoved(const FGameplayEffectRemovalInfo& Info);
+	/**
+	 * Called by UGAEAbilitySystemComponent when the cooldown GameplayEffect of the ability spec is added
+	 */
+	void HandleCooldownEffectAdded(UGAEAbilitySystemComponent* GAEASC, const FGameplayAbilitySpecHandle SpecHandle, const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle Handle);
+	void HandleCDGameplayEffectRemoved(const FGameplayEffectRemovalInfo& Info, TWeakObjectPtr<UAbilitySystemComponent> WeakASC, FGameplayAbilitySpecHandle SpecHandle);
+	void HandleCDGameplayEffectTimeChanged(FActiveGameplayEffectHandle Handle, float NewStartTime, float NewDuration, TWeakObjectPtr<UAbilitySystemComponent> WeakASC, FGameplayAbilitySpecHandle SpecHandle);
+
+	/**
+	 * Stops listening for the removal and time changes of the cooldown GameplayEffect
+	 */
+	void UnbindCooldownEffectDelegates(UAbilitySystemComponent* ASC, FActiveGameplayEffectHandle Handle);
+
+protected:
+	/**
+	 * Dispatches the start and end of the cooldown of the ability spec
+	 * 
+	 * Tips:
+	 *	Instanced abilities call OnCooldownStart() and OnCooldownEnd().
+	 *	NonInstanced abilities have no current actor info to call them with, so only the message and the costs are notified.
+	 */
+	void DispatchCooldownStart(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float Duration);
+	void DispatchCooldownEnd(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo);
 
 protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "Cooldowns")
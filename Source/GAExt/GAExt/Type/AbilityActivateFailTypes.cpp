@@ -0,0 +1,65 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityActivateFailTypes.h"
+
+#include "GameplayTag/GAETags_Ability.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityActivateFailTypes)
+
+
+namespace AbilityActivateFail
+{
+	struct FFailTagToFlag
+	{
+		const FNativeGameplayTag& Tag;
+		EAbilityActivateFailFlags Flag;
+	};
+
+	static const FFailTagToFlag FailTagToFlags[]
+	{
+		{ TAG_Ability_ActivateFail_IsDead		, EAbilityActivateFailFlags::IsDead },
+		{ TAG_Ability_ActivateFail_Cooldown		, EAbilityActivateFailFlags::Cooldown },
+		{ TAG_Ability_ActivateFail_TagsBlocked	, EAbilityActivateFailFlags::TagsBlocked },
+		{ TAG_Ability_ActivateFail_TagsMissing	, EAbilityActivateFailFlags::TagsMissing },
+		{ TAG_Ability_ActivateFail_Networking	, EAbilityActivateFailFlags::Networking },
+		{ TAG_Ability_ActivateFail_Cost			, EAbilityActivateFailFlags::Cost },
+	};
+
+
+	bool TagsToFlags(const FGameplayTagContainer& FailureTags, EAbilityActivateFailFlags& OutFlags)
+	{
+		auto bAllRepresented{ true };
+
+		OutFlags = EAbilityActivateFailFlags::None;
+
+		for (const auto& Tag : FailureTags)
+		{
+			auto bFound{ false };
+
+			for (const auto& Entry : FailTagToFlags)
+			{
+				if (Tag == Entry.Tag.GetTag())
+				{
+					OutFlags |= Entry.Flag;
+					bFound = true;
+					break;
+				}
+			}
+
+			bAllRepresented &= bFound;
+		}
+
+		return bAllRepresented;
+	}
+
+	void FlagsToTags(EAbilityActivateFailFlags Flags, FGameplayTagContainer& OutFailureTags)
+	{
+		for (const auto& Entry : FailTagToFlags)
+		{
+			if (EnumHasAnyFlags(Flags, Entry.Flag))
+			{
+				OutFailureTags.AddTag(Entry.Tag.GetTag());
+			}
+		}
+	}
+}
@@ -0,0 +1,41 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+
+#include "AbilityActivateFailTypes.generated.h"
+
+
+/**
+ * Compact representation of the "Ability.ActivateFail.*" tags used to tell why an ability failed to activate
+ */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EAbilityActivateFailFlags : uint8
+{
+	None			= 0			UMETA(Hidden),
+
+	IsDead			= 1 << 0,
+	Cooldown		= 1 << 1,
+	TagsBlocked		= 1 << 2,
+	TagsMissing		= 1 << 3,
+	Networking		= 1 << 4,
+	Cost			= 1 << 5,
+};
+ENUM_CLASS_FLAGS(EAbilityActivateFailFlags);
+
+
+namespace AbilityActivateFail
+{
+	/**
+	 * Converts the failure tags to flags.
+	 * 
+	 * Returns true if all tags in the container could be represented by the flags.
+	 */
+	GAEXT_API bool TagsToFlags(const FGameplayTagContainer& FailureTags, EAbilityActivateFailFlags& OutFlags);
+
+	/**
+	 * Adds the failure tags represented by the flags to the container
+	 */
+	GAEXT_API void FlagsToTags(EAbilityActivateFailFlags Flags, FGameplayTagContainer& OutFailureTags);
+}
@@ -0,0 +1,201 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityActivationStatTypes.h"
+
+#include "GAExtLogs.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/ObjectKey.h"
+
+
+//////////////////////////////////////////////////////////////////////
+// AbilityActivationStatsCvars
+
+#pragma region AbilityActivationStatsCvars
+
+namespace AbilityActivationStatsCvars
+{
+	static bool bEnableAbilityActivationStats{ false };
+	static FAutoConsoleVariableRef CVarEnableAbilityActivationStats(
+		TEXT("GAE.AbilityActivationStats"),
+		bEnableAbilityActivationStats,
+		TEXT("Records the calls, failures and time of each CanActivateAbility() stage per ability class."));
+
+	static FAutoConsoleCommand CVarDumpAbilityActivationStats(
+		TEXT("GAE.DumpAbilityActivationStats"),
+		TEXT("Shows the CanActivateAbility() stage counters of each ability class, sorted by total time."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(FAbilityActivationStatsRecorder::DumpStats));
+
+	static FAutoConsoleCommand CVarResetAbilityActivationStats(
+		TEXT("GAE.ResetAbilityActivationStats"),
+		TEXT("Clears the CanActivateAbility() stage counters."),
+		FConsoleCommandDelegate::CreateStatic(FAbilityActivationStatsRecorder::ResetStats));
+}
+
+#pragma endregion
+
+
+//////////////////////////////////////////////////////////////////////
+// AbilityActivationStats
+
+#pragma region AbilityActivationStats
+
+namespace AbilityActivationStats
+{
+	static constexpr auto NumStages{ static_cast<int32>(EAbilityActivationStage::MAX) };
+
+	struct FStageCounters
+	{
+		uint64 Calls{ 0 };
+		uint64 Failures{ 0 };
+		uint64 Cycles{ 0 };
+	};
+
+	struct FClassCounters
+	{
+		FString ClassName;
+
+		FStageCounters Stages[NumStages];
+
+		uint64 GetTotalCycles() const
+		{
+			auto TotalCycles{ uint64(0) };
+
+			for (const auto& StageCounters : Stages)
+			{
+				TotalCycles += StageCounters.Cycles;
+			}
+
+			return TotalCycles;
+		}
+	};
+
+	static FCriticalSection CountersLock;
+	static TMap<TObjectKey<UClass>, FClassCounters> Counters;
+
+	static const TCHAR* GetStageName(int32 StageIndex)
+	{
+		switch (static_cast<EAbilityActivationStage>(StageIndex))
+		{
+		case EAbilityActivationStage::AvatarRole:			return TEXT("AvatarRole");
+		case EAbilityActivationStage::Inhibition:			return TEXT("Inhibition");
+		case EAbilityActivationStage::Cooldown:				return TEXT("Cooldown");
+		case EAbilityActivationStage::Cost:					return TEXT("Cost");
+		case EAbilityActivationStage::TagRequirements:		return TEXT("TagRequirements");
+		case EAbilityActivationStage::InputBlock:			return TEXT("InputBlock");
+		case EAbilityActivationStage::BlueprintCanActivate:	return TEXT("BlueprintCanActivate");
+		default:											return TEXT("Unknown");
+		}
+	}
+}
+
+#pragma endregion
+
+
+//////////////////////////////////////////////////////////////////////
+// FAbilityActivationStatsRecorder
+
+#pragma region FAbilityActivationStatsRecorder
+
+FAbilityActivationStatsRecorder::FAbilityActivationStatsRecorder(const UClass* InAbilityClass)
+{
+#if WITH_ABILITY_ACTIVATION_STATS
+	AbilityClass = InAbilityClass;
+	bEnabled = AbilityActivationStatsCvars::bEnableAbilityActivationStats && (InAbilityClass != nullptr);
+#endif
+}
+
+FAbilityActivationStatsRecorder::~FAbilityActivationStatsRecorder()
+{
+#if WITH_ABILITY_ACTIVATION_STATS
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	// Lock once per CanActivateAbility() call rather than once per stage.
+
+	FScopeLock Lock{ &AbilityActivationStats::CountersLock };
+
+	auto& ClassCounters{ AbilityActivationStats::Counters.FindOrAdd(AbilityClass) };
+
+	if (ClassCounters.ClassName.IsEmpty())
+	{
+		ClassCounters.ClassName = GetNameSafe(AbilityClass);
+	}
+
+	for (auto StageIndex{ 0 }; StageIndex < AbilityActivationStats::NumStages; ++StageIndex)
+	{
+		auto& StageCounters{ ClassCounters.Stages[StageIndex] };
+		StageCounters.Calls += Calls[StageIndex];
+		StageCounters.Failures += Failures[StageIndex];
+		StageCounters.Cycles += Cycles[StageIndex];
+	}
+#endif
+}
+
+void FAbilityActivationStatsRecorder::AddStage(EAbilityActivationStage Stage, bool bPassed, uint64 StageCycles)
+{
+#if WITH_ABILITY_ACTIVATION_STATS
+	const auto StageIndex{ static_cast<uint8>(Stage) };
+
+	Calls[StageIndex]++;
+	Failures[StageIndex] += bPassed ? 0 : 1;
+	Cycles[StageIndex] += StageCycles;
+#endif
+}
+
+
+void FAbilityActivationStatsRecorder::DumpStats(const TArray<FString>& Args)
+{
+	TArray<AbilityActivationStats::FClassCounters> SortedCounters;
+
+	{
+		FScopeLock Lock{ &AbilityActivationStats::CountersLock };
+
+		AbilityActivationStats::Counters.GenerateValueArray(SortedCounters);
+	}
+
+	SortedCounters.Sort([](const auto& A, const auto& B) { return A.GetTotalCycles() > B.GetTotalCycles(); });
+
+	if (!AbilityActivationStatsCvars::bEnableAbilityActivationStats)
+	{
+		UE_LOG(LogGameExt_Ability, Warning, TEXT("Ability activation stats are not being recorded. Set \"GAE.AbilityActivationStats 1\" to record them."));
+	}
+
+	UE_LOG(LogGameExt_Ability, Log, TEXT("=========== Dumping Ability Activation Stats ==========="));
+
+	for (const auto& ClassCounters : SortedCounters)
+	{
+		UE_LOG(LogGameExt_Ability, Log, TEXT("  %s (Total: %.3f ms)"), *ClassCounters.ClassName, FPlatformTime::ToMilliseconds64(ClassCounters.GetTotalCycles()));
+
+		for (auto StageIndex{ 0 }; StageIndex < AbilityActivationStats::NumStages; ++StageIndex)
+		{
+			const auto& StageCounters{ ClassCounters.Stages[StageIndex] };
+
+			if (StageCounters.Calls > 0)
+			{
+				const auto TotalMs{ FPlatformTime::ToMilliseconds64(StageCounters.Cycles) };
+
+				UE_LOG(LogGameExt_Ability, Log, TEXT("    %-20s Calls: %8llu  Failures: %8llu  Total: %8.3f ms  Avg: %7.3f us"),
+					AbilityActivationStats::GetStageName(StageIndex),
+					StageCounters.Calls,
+					StageCounters.Failures,
+					TotalMs,
+					TotalMs * 1000.0 / StageCounters.Calls);
+			}
+		}
+	}
+
+	UE_LOG(LogGameExt_Ability, Log, TEXT("=========== Dumped %d Ability Classes ==========="), SortedCounters.Num());
+}
+
+void FAbilityActivationStatsRecorder::ResetStats()
+{
+	FScopeLock Lock{ &AbilityActivationStats::CountersLock };
+
+	AbilityActivationStats::Counters.Reset();
+}
+
+#pragma endregion
@@ -0,0 +1,112 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UClass;
+
+#ifndef WITH_ABILITY_ACTIVATION_STATS
+#define WITH_ABILITY_ACTIVATION_STATS !UE_BUILD_SHIPPING
+#endif
+
+
+/**
+ * Stages of UGAEGameplayAbility::CanActivateAbility()
+ */
+enum class EAbilityActivationStage : uint8
+{
+	AvatarRole,
+	Inhibition,
+	Cooldown,
+	Cost,
+	TagRequirements,
+	InputBlock,
+	BlueprintCanActivate,
+
+	MAX
+};
+
+
+/**
+ * Records the calls, failures and time of each activation stage of a single CanActivateAbility() call,
+ * and adds them to the per-ability-class counters when it goes out of scope.
+ * 
+ * Tips:
+ *	Recording is enabled with "GAE.AbilityActivationStats 1".
+ *	Counters are dumped with "GAE.DumpAbilityActivationStats" and cleared with "GAE.ResetAbilityActivationStats".
+ */
+class GAEXT_API FAbilityActivationStatsRecorder
+{
+public:
+	explicit FAbilityActivationStatsRecorder(const UClass* InAbilityClass);
+	~FAbilityActivationStatsRecorder();
+
+#if WITH_ABILITY_ACTIVATION_STATS
+private:
+	const UClass* AbilityClass{ nullptr };
+
+	uint32 Calls[static_cast<uint8>(EAbilityActivationStage::MAX)]{ 0 };
+	uint32 Failures[static_cast<uint8>(EAbilityActivationStage::MAX)]{ 0 };
+	uint64 Cycles[static_cast<uint8>(EAbilityActivationStage::MAX)]{ 0 };
+
+	bool bEnabled{ false };
+#endif
+
+public:
+	bool IsEnabled() const
+	{
+#if WITH_ABILITY_ACTIVATION_STATS
+		return bEnabled;
+#else
+		return false;
+#endif
+	}
+
+	void AddStage(EAbilityActivationStage Stage, bool bPassed, uint64 StageCycles);
+
+public:
+	static void DumpStats(const TArray<FString>& Args);
+	static void ResetStats();
+};
+
+
+/**
+ * Records a single stage to the FAbilityActivationStatsRecorder while in scope
+ */
+class FAbilityActivationStageScope
+{
+public:
+	FAbilityActivationStageScope(FAbilityActivationStatsRecorder& InRecorder, EAbilityActivationStage InStage)
+		: Recorder(InRecorder)
+		, Stage(InStage)
+		, StartCycles(InRecorder.IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{}
+
+	~FAbilityActivationStageScope()
+	{
+		if (Recorder.IsEnabled())
+		{
+			Recorder.AddStage(Stage, bPassed, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	FAbilityActivationStatsRecorder& Recorder;
+
+	EAbilityActivationStage Stage;
+
+	uint64 StartCycles;
+
+	bool bPassed{ true };
+
+public:
+	/**
+	 * Returns bInPassed so that it can wrap the condition of the stage
+	 */
+	bool Passed(bool bInPassed)
+	{
+		bPassed = bInPassed;
+		return bInPassed;
+	}
+};
@@ -36,4 +36,10 @@ public:
 	UPROPERTY(BlueprintReadWrite)
 	float Duration{ 0.0f };
 
+	//
+	// Server world time when the cooldown ends, or when it ended for the end message
+	//
+	UPROPERTY(BlueprintReadWrite)
+	double EndTime{ 0.0 };
+
 };
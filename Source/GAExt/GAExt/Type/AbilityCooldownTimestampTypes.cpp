@@ -0,0 +1,125 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityCooldownTimestampTypes.h"
+
+#include "GAEAbilitySystemComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityCooldownTimestampTypes)
+
+
+//////////////////////////////////////////////////////////////////////
+// FAbilityCooldownTimestamp
+
+#pragma region FAbilityCooldownTimestamp
+
+int32 FAbilityCooldownTimestamp::GetCharges(double Time) const
+{
+	if (RechargeInterval <= 0.0f)
+	{
+		return MaxCharges;
+	}
+
+	const auto MissingCharges{ FMath::CeilToInt32((EndTime - Time) / RechargeInterval) };
+
+	return MaxCharges - FMath::Clamp(MissingCharges, 0, static_cast<int32>(MaxCharges));
+}
+
+
+void FAbilityCooldownTimestamp::PostReplicatedAdd(const FAbilityCooldownTimestampContainer& InArraySerializer)
+{
+	if (auto* Owner{ InArraySerializer.Owner.Get() })
+	{
+		Owner->HandleTimestampCooldownUpdated(*this);
+		Owner->ScheduleTimestampCooldownTimer();
+	}
+}
+
+void FAbilityCooldownTimestamp::PostReplicatedChange(const FAbilityCooldownTimestampContainer& InArraySerializer)
+{
+	// A charge was used before all of them were recharged.
+
+	if (auto* Owner{ InArraySerializer.Owner.Get() })
+	{
+		Owner->HandleTimestampCooldownUpdated(*this);
+		Owner->ScheduleTimestampCooldownTimer();
+	}
+}
+
+void FAbilityCooldownTimestamp::PreReplicatedRemove(const FAbilityCooldownTimestampContainer& InArraySerializer)
+{
+	if (auto* Owner{ InArraySerializer.Owner.Get() })
+	{
+		Owner->HandleTimestampCooldownRemoved(Handle);
+		Owner->ScheduleTimestampCooldownTimer();
+	}
+}
+
+#pragma endregion
+
+
+//////////////////////////////////////////////////////////////////////
+// FAbilityCooldownTimestampContainer
+
+#pragma region FAbilityCooldownTimestampContainer
+
+const FAbilityCooldownTimestamp& FAbilityCooldownTimestampContainer::UseCharge(const FGameplayAbilitySpecHandle& Handle, double Time, float RechargeInterval, uint8 MaxCharges)
+{
+	auto* Item{ Items.FindByPredicate([&Handle](const FAbilityCooldownTimestamp& Item) { return Item.Handle == Handle; }) };
+
+	if (!Item)
+	{
+		Item = &Items.Emplace_GetRef(Handle, RechargeInterval, MaxCharges);
+	}
+
+	// The used charge is recharged after the ones already recharging.
+
+	Item->StartTime = Time;
+	Item->EndTime = FMath::Max(Item->EndTime, Time) + RechargeInterval;
+	Item->RechargeInterval = RechargeInterval;
+	Item->MaxCharges = MaxCharges;
+
+	MarkItemDirty(*Item);
+
+	return *Item;
+}
+
+bool FAbilityCooldownTimestampContainer::Remove(const FGameplayAbilitySpecHandle& Handle)
+{
+	const auto Index{ Items.IndexOfByPredicate([&Handle](const FAbilityCooldownTimestamp& Item) { return Item.Handle == Handle; }) };
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	Items.RemoveAtSwap(Index, 1, false);
+
+	MarkArrayDirty();
+
+	return true;
+}
+
+void FAbilityCooldownTimestampContainer::RemoveExpired(double Time, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>>& OutHandles)
+{
+	for (auto Index{ Items.Num() - 1 }; Index >= 0; --Index)
+	{
+		if (Items[Index].EndTime <= Time)
+		{
+			OutHandles.Add(Items[Index].Handle);
+
+			Items.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	if (!OutHandles.IsEmpty())
+	{
+		MarkArrayDirty();
+	}
+}
+
+const FAbilityCooldownTimestamp* FAbilityCooldownTimestampContainer::Find(const FGameplayAbilitySpecHandle& Handle) const
+{
+	return Items.FindByPredicate([&Handle](const FAbilityCooldownTimestamp& Item) { return Item.Handle == Handle; });
+}
+
+#pragma endregion
@@ -0,0 +1,134 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "GameplayAbilitySpecHandle.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "AbilityCooldownTimestampTypes.generated.h"
+
+class UGAEAbilitySystemComponent;
+
+
+/**
+ * Cooldown of an ability spec represented only by its start and end time
+ * 
+ * Tips:
+ *	With multiple charges, each use pushes EndTime back by RechargeInterval and the charges are recharged one by one until EndTime.
+ *	The remaining charges are derived from EndTime when queried, so recharging a charge writes nothing.
+ */
+USTRUCT()
+struct FAbilityCooldownTimestamp : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	FAbilityCooldownTimestamp() {}
+
+	FAbilityCooldownTimestamp(const FGameplayAbilitySpecHandle& InHandle, float InRechargeInterval, uint8 InMaxCharges)
+		: Handle(InHandle), RechargeInterval(InRechargeInterval), MaxCharges(InMaxCharges)
+	{}
+
+public:
+	UPROPERTY()
+	FGameplayAbilitySpecHandle Handle;
+
+	//
+	// Server world time when a charge was last used
+	//
+	UPROPERTY()
+	double StartTime{ 0.0 };
+
+	//
+	// Server world time when all charges are recharged
+	//
+	UPROPERTY()
+	double EndTime{ 0.0 };
+
+	//
+	// Time to recharge a single charge
+	//
+	UPROPERTY()
+	float RechargeInterval{ 0.0f };
+
+	UPROPERTY()
+	uint8 MaxCharges{ 1 };
+
+public:
+	/**
+	 * Returns the number of charges available at the time
+	 */
+	int32 GetCharges(double Time) const;
+
+	/**
+	 * Returns the server world time when at least one charge is available
+	 */
+	double GetReadyTime() const { return EndTime - static_cast<double>(MaxCharges - 1) * RechargeInterval; }
+
+public:
+	void PostReplicatedAdd(const struct FAbilityCooldownTimestampContainer& InArraySerializer);
+	void PostReplicatedChange(const struct FAbilityCooldownTimestampContainer& InArraySerializer);
+	void PreReplicatedRemove(const struct FAbilityCooldownTimestampContainer& InArraySerializer);
+
+};
+
+
+/**
+ * Replicated list of the timestamp cooldowns in progress on an AbilitySystemComponent
+ * 
+ * Tips:
+ *	Starting a cooldown only adds an item, so there is no GameplayEffect spec, active effect, aggregator or effect replication involved.
+ */
+USTRUCT()
+struct FAbilityCooldownTimestampContainer : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	friend struct FAbilityCooldownTimestamp;
+public:
+	FAbilityCooldownTimestampContainer() {}
+
+protected:
+	UPROPERTY()
+	TArray<FAbilityCooldownTimestamp> Items;
+
+	UPROPERTY(NotReplicated)
+	TObjectPtr<UGAEAbilitySystemComponent> Owner{ nullptr };
+
+public:
+	void SetOwner(UGAEAbilitySystemComponent* InOwner) { Owner = InOwner; }
+
+	/**
+	 * Uses a charge of the ability spec at the time, adding the cooldown if it is not in progress
+	 */
+	const FAbilityCooldownTimestamp& UseCharge(const FGameplayAbilitySpecHandle& Handle, double Time, float RechargeInterval, uint8 MaxCharges);
+
+	/**
+	 * Removes the cooldown of the ability spec and returns whether it existed
+	 */
+	bool Remove(const FGameplayAbilitySpecHandle& Handle);
+
+	/**
+	 * Removes the cooldowns that have fully ended by the time and returns their ability specs
+	 */
+	void RemoveExpired(double Time, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>>& OutHandles);
+
+	const FAbilityCooldownTimestamp* Find(const FGameplayAbilitySpecHandle& Handle) const;
+
+	const TArray<FAbilityCooldownTimestamp>& GetItems() const { return Items; }
+
+public:
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FAbilityCooldownTimestamp, FAbilityCooldownTimestampContainer>(Items, DeltaParms, *this);
+	}
+
+};
+
+template<>
+struct TStructOpsTypeTraits<FAbilityCooldownTimestampContainer> : public TStructOpsTypeTraitsBase2<FAbilityCooldownTimestampContainer>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
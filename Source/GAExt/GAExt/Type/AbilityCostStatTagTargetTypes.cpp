@@ -0,0 +1,140 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityCostStatTagTargetTypes.h"
+
+#include "GameplayAbilitySpec.h"
+
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/Actor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityCostStatTagTargetTypes)
+
+
+//////////////////////////////////////////////////////////////////////
+// FStatTagCostTargets
+
+#pragma region FStatTagCostTargets
+
+void FStatTagCostTargets::Resolve(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec* Spec)
+{
+	OwnerActor = ActorInfo->OwnerActor;
+	AvatarActor = ActorInfo->AvatarActor;
+	PlayerController = ActorInfo->PlayerController;
+	AvatarPawn = Cast<APawn>(ActorInfo->AvatarActor.Get());
+	AvatarPawnController = AvatarPawn.IsValid() ? AvatarPawn->GetController() : nullptr;
+
+	for (uint8 Index{ 0 }; Index < static_cast<uint8>(EStatTagCostTarget::MAX); ++Index)
+	{
+		auto* TargetObject{ ResolveTarget(static_cast<EStatTagCostTarget>(Index), ActorInfo, Spec) };
+
+		Targets[Index] = TWeakInterfacePtr<IGameplayTagStackInterface>(TargetObject);
+	}
+}
+
+bool FStatTagCostTargets::IsUpToDate(const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	if ((OwnerActor != ActorInfo->OwnerActor) || (AvatarActor != ActorInfo->AvatarActor) || (PlayerController != ActorInfo->PlayerController))
+	{
+		return false;
+	}
+
+	// Possession of the avatar may change without updating the ActorInfo (e.g, AIController)
+
+	if (const auto* Pawn{ AvatarPawn.Get() })
+	{
+		return (Pawn->GetController() == AvatarPawnController.Get());
+	}
+
+	return true;
+}
+
+UObject* FStatTagCostTargets::ResolveTarget(EStatTagCostTarget Type, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec* Spec)
+{
+	auto* AvatarPawn{ Cast<APawn>(ActorInfo->AvatarActor.Get()) };
+
+	switch (Type)
+	{
+	case EStatTagCostTarget::SourceObject:
+		return Spec ? Spec->SourceObject.Get() : nullptr;
+		break;
+
+	case EStatTagCostTarget::Avatar:
+		return ActorInfo->AvatarActor.Get();
+		break;
+
+	case EStatTagCostTarget::Owner:
+		return ActorInfo->OwnerActor.Get();
+		break;
+
+	case EStatTagCostTarget::Controller:
+	{
+		// Same as UGAEGameplayAbility::GetController()
+
+		if (auto* PC{ ActorInfo->PlayerController.Get() })
+		{
+			return PC;
+		}
+
+		for (auto* TestActor{ ActorInfo->OwnerActor.Get() }; TestActor; TestActor = TestActor->GetOwner())
+		{
+			if (auto* Controller{ Cast<AController>(TestActor) })
+			{
+				return Controller;
+			}
+
+			if (auto* Pawn{ Cast<APawn>(TestActor) })
+			{
+				return Pawn->GetController();
+			}
+		}
+
+		return nullptr;
+		break;
+	}
+
+	case EStatTagCostTarget::PlayerState:
+	{
+		// Same as UGAEGameplayAbility::GetPlayerState()
+
+		if (auto* PS_FromPC{ ActorInfo->PlayerController.IsValid() ? ActorInfo->PlayerController->GetPlayerState<APlayerState>() : nullptr })
+		{
+			return PS_FromPC;
+		}
+
+		if (auto* PS_Avatar{ Cast<APlayerState>(ActorInfo->AvatarActor.Get()) })
+		{
+			return PS_Avatar;
+		}
+
+		if (auto* PS_Owner{ Cast<APlayerState>(ActorInfo->OwnerActor.Get()) })
+		{
+			return PS_Owner;
+		}
+
+		if (AvatarPawn)
+		{
+			if (auto* PS_FromPawn{ AvatarPawn->GetPlayerState() })
+			{
+				return PS_FromPawn;
+			}
+
+			if (auto* Controller{ AvatarPawn->GetController() })
+			{
+				return Controller->GetPlayerState<APlayerState>();
+			}
+		}
+
+		return nullptr;
+		break;
+	}
+
+	default:
+		return nullptr;
+		break;
+	}
+}
+
+#pragma endregion
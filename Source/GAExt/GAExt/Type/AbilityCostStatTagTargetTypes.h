@@ -2,8 +2,18 @@
 
 #pragma once
 
+#include "GameplayTag/GameplayTagStackInterface.h"
+
+#include "UObject/WeakInterfacePtr.h"
+
 #include "AbilityCostStatTagTargetTypes.generated.h"
 
+class APlayerController;
+class AController;
+class APawn;
+struct FGameplayAbilityActorInfo;
+struct FGameplayAbilitySpec;
+
 
 /**
  * Enumeration to determine targets related to ability cost
@@ -24,5 +34,59 @@ enum class EStatTagCostTarget : uint8
 	Controller,
 
 	// PlayerState in ActorInfo of the ability that holds the AbilityCost
-	PlayerState
+	PlayerState,
+
+	MAX				UMETA(Hidden)
+};
+
+
+/**
+ * Cost targets of each EStatTagCostTarget resolved from the ActorInfo of an ability spec
+ */
+struct GAEXT_API FStatTagCostTargets
+{
+public:
+	FStatTagCostTargets() {}
+
+public:
+	//
+	// ActorInfo values at the time of resolution used to detect changes in avatar or possession
+	//
+	TWeakObjectPtr<AActor> OwnerActor;
+	TWeakObjectPtr<AActor> AvatarActor;
+	TWeakObjectPtr<APlayerController> PlayerController;
+	TWeakObjectPtr<APawn> AvatarPawn;
+	TWeakObjectPtr<AController> AvatarPawnController;
+
+	//
+	// Resolved interface for each EStatTagCostTarget
+	//
+	TWeakInterfacePtr<IGameplayTagStackInterface> Targets[static_cast<uint8>(EStatTagCostTarget::MAX)];
+
+public:
+	/**
+	 * Resolves the targets of all types from the ActorInfo and the spec
+	 *
+	 * Note:
+	 *	Resolved without the current actor info of the ability, since NonInstanced abilities have none.
+	 *	Spec can be nullptr, in which case the SourceObject target is not resolved.
+	 */
+	void Resolve(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec* Spec);
+
+	/**
+	 * Returns whether the resolved targets still match the ActorInfo
+	 */
+	bool IsUpToDate(const FGameplayAbilityActorInfo* ActorInfo) const;
+
+	const TWeakInterfacePtr<IGameplayTagStackInterface>& GetTarget(EStatTagCostTarget Type) const
+	{
+		return Targets[static_cast<uint8>(Type)];
+	}
+
+protected:
+	/**
+	 * Returns the cost target of the type resolved from the ActorInfo and the spec
+	 */
+	static UObject* ResolveTarget(EStatTagCostTarget Type, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec* Spec);
+
 };
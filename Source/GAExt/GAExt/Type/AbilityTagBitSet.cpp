@@ -0,0 +1,152 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AbilityTagBitSet.h"
+
+#include "GameplayTagsManager.h"
+
+
+int32 FAbilityTagBitSet::GetTagIndex(const FGameplayTag& Tag)
+{
+	if (!Tag.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	const auto NetIndex{ UGameplayTagsManager::Get().GetNetIndexFromTag(Tag) };
+
+	return (NetIndex == INVALID_TAGNETINDEX) ? INDEX_NONE : static_cast<int32>(NetIndex);
+}
+
+bool FAbilityTagBitSet::AddTag(const FGameplayTag& Tag, bool bWithParents)
+{
+	if (!bWithParents)
+	{
+		const auto BitIndex{ GetTagIndex(Tag) };
+
+		if (BitIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		SetBit(BitIndex, true);
+		return true;
+	}
+
+	auto bAllAdded{ true };
+
+	for (auto Current{ Tag }; Current.IsValid(); Current = Current.RequestDirectParent())
+	{
+		bAllAdded &= AddTag(Current, false);
+	}
+
+	return bAllAdded;
+}
+
+bool FAbilityTagBitSet::AddTags(const FGameplayTagContainer& Tags, bool bWithParents)
+{
+	auto bAllAdded{ true };
+
+	for (const auto& Tag : Tags)
+	{
+		bAllAdded &= AddTag(Tag, bWithParents);
+	}
+
+	return bAllAdded;
+}
+
+void FAbilityTagBitSet::SetTag(const FGameplayTag& Tag, bool bContains)
+{
+	const auto BitIndex{ GetTagIndex(Tag) };
+
+	if (BitIndex != INDEX_NONE)
+	{
+		SetBit(BitIndex, bContains);
+	}
+}
+
+void FAbilityTagBitSet::Reset()
+{
+	Words.Reset();
+}
+
+bool FAbilityTagBitSet::IsEmpty() const
+{
+	for (const auto& Word : Words)
+	{
+		if (Word != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FAbilityTagBitSet::HasTag(const FGameplayTag& Tag) const
+{
+	const auto BitIndex{ GetTagIndex(Tag) };
+
+	if (BitIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const auto WordIndex{ BitIndex / 64 };
+
+	return Words.IsValidIndex(WordIndex) && ((Words[WordIndex] & (1ull << (BitIndex % 64))) != 0);
+}
+
+bool FAbilityTagBitSet::HasAny(const FAbilityTagBitSet& Other) const
+{
+	const auto NumWords{ FMath::Min(Words.Num(), Other.Words.Num()) };
+
+	for (auto WordIndex{ 0 }; WordIndex < NumWords; ++WordIndex)
+	{
+		if ((Words[WordIndex] & Other.Words[WordIndex]) != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FAbilityTagBitSet::HasAll(const FAbilityTagBitSet& Other) const
+{
+	for (auto WordIndex{ 0 }; WordIndex < Other.Words.Num(); ++WordIndex)
+	{
+		const auto Word{ Words.IsValidIndex(WordIndex) ? Words[WordIndex] : 0ull };
+
+		if ((Other.Words[WordIndex] & ~Word) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FAbilityTagBitSet::SetBit(int32 BitIndex, bool bValue)
+{
+	const auto WordIndex{ BitIndex / 64 };
+	const auto Mask{ 1ull << (BitIndex % 64) };
+
+	if (!Words.IsValidIndex(WordIndex))
+	{
+		if (!bValue)
+		{
+			return;
+		}
+
+		Words.AddZeroed(WordIndex + 1 - Words.Num());
+	}
+
+	if (bValue)
+	{
+		Words[WordIndex] |= Mask;
+	}
+	else
+	{
+		Words[WordIndex] &= ~Mask;
+	}
+}
@@ -0,0 +1,67 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+
+
+/**
+ * Dense set of gameplay tags with one bit per tag, indexed by the net index of the tag.
+ * 
+ * Tips:
+ *	HasAny() and HasAll() are a few word-wide AND operations, which is much cheaper than the FGameplayTagContainer ones.
+ *	Add the tags with their parents to the set that is queried, and the exact tags to the set that is queried for,
+ *	to get the same result as FGameplayTagContainer::HasAny() and FGameplayTagContainer::HasAll().
+ * 
+ * Note:
+ *	Net indices are assumed not to change while the game is running.
+ */
+struct GAEXT_API FAbilityTagBitSet
+{
+public:
+	FAbilityTagBitSet() {}
+
+protected:
+	TArray<uint64, TInlineAllocator<4>> Words;
+
+public:
+	/**
+	 * Returns the bit index of the tag, or INDEX_NONE if the tag has no net index
+	 */
+	static int32 GetTagIndex(const FGameplayTag& Tag);
+
+	/**
+	 * Adds the tag, and its parent tags if bWithParents.
+	 * Returns false if the tag could not be represented.
+	 */
+	bool AddTag(const FGameplayTag& Tag, bool bWithParents);
+	bool AddTags(const FGameplayTagContainer& Tags, bool bWithParents);
+
+	/**
+	 * Sets whether the set contains the tag, parent tags are not affected
+	 */
+	void SetTag(const FGameplayTag& Tag, bool bContains);
+
+	void Reset();
+
+	bool IsEmpty() const;
+
+	/**
+	 * Returns whether the set contains the exact tag
+	 */
+	bool HasTag(const FGameplayTag& Tag) const;
+
+	/**
+	 * Returns whether the set contains any of the tags in Other
+	 */
+	bool HasAny(const FAbilityTagBitSet& Other) const;
+
+	/**
+	 * Returns whether the set contains all of the tags in Other
+	 */
+	bool HasAll(const FAbilityTagBitSet& Other) const;
+
+protected:
+	void SetBit(int32 BitIndex, bool bValue);
+
+};